@@ -0,0 +1,51 @@
+#ifndef CHUNKED_ARENA
+#define CHUNKED_ARENA
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Arena of nodes in fixed-size chunks addressed by 32-bit indices, so growing it never moves
+ * nodes, index 0 is reserved as null
+ * Nodes are freed all at once, compaction copies live nodes into a fresh arena
+ * Complexity: O(1) per access, amortized O(1) per create
+ */
+template <class node_t>
+class chunked_arena_t {
+    static constexpr int CHUNK_BITS = 16;
+    static constexpr uint32_t CHUNK = 1u << CHUNK_BITS;
+
+    uint32_t cnt = 1;
+    std::vector<std::unique_ptr<node_t[]>> chunks;
+
+   public:
+    node_t& operator[](uint32_t u) { return chunks[u >> CHUNK_BITS][u & (CHUNK - 1)]; }
+
+    const node_t& operator[](uint32_t u) const { return chunks[u >> CHUNK_BITS][u & (CHUNK - 1)]; }
+
+    // Makes sure that nodes with indices below cap are allocated
+    void reserve(size_t cap) {
+        assert(cap <= UINT32_MAX);
+        while (chunks.size() * CHUNK < cap) chunks.emplace_back(new node_t[CHUNK]);
+    }
+
+    // Stores a copy of x, returns its index
+    uint32_t create(const node_t& x) {
+        assert(cnt != 0);
+        reserve(cnt + 1);
+        (*this)[cnt] = x;
+        return cnt++;
+    }
+
+    // Number of created nodes, the null one is not counted
+    size_t size() const { return cnt - 1; }
+
+    void swap(chunked_arena_t& other) {
+        std::swap(cnt, other.cnt);
+        chunks.swap(other.chunks);
+    }
+};
+
+#endif /* CHUNKED_ARENA */
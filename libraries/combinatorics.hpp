@@ -1,161 +1,74 @@
 #ifndef COMBINATORICS
 #define COMBINATORICS
 
-#include <iostream>
-#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "modular.hpp"
+#include "ntt.hpp"
+
 /*
- * Modular integer class
- * MOD must be prime to use inverse and division
- * 2 * (MOD - 1) <= INT_MAX must hold
+ * No need to run any init function, it dynamically resizes the data.
+ * Published tables are immutable and reads are lock-free, so any thread may use them;
+ * call reserve(n) before starting worker threads to avoid growth under the lock.
  */
-template <int mod>
-struct modular_int_t {
-    static_assert(mod - 2 <= std::numeric_limits<int>::max() - mod, "2 * (mod - 1) <= INT_MAX");
-    using mint = modular_int_t<mod>;
-
-    int value;
-
-    modular_int_t() : value(0) {}
-    modular_int_t(const mint& other) : value(other.value) {}
-
-    template <class T>
-    modular_int_t(T x) : value(normalize(x)) {}
-
-    template <class T>
-    static int normalize(T x) {
-        static_assert(std::is_integral<T>::value);
-        if (x < -mod || x > 2 * mod - 1) x %= mod;
-        if (x >= mod) x -= mod;
-        if (x < 0) x += mod;
-        return x;
-    }
-
-    template <class T>
-    mint power(T deg) const {
-        static_assert(std::is_integral<T>::value);
-        mint res(1), x = *this;
-        while (deg > 0) {
-            if (deg & 1) res *= x;
-            x *= x;
-            deg >>= 1;
-        }
-        return res;
-    }
-
-    mint inverse() const { return power(mod - 2); }
-
-    mint& operator=(const mint& other) {
-        value = other.value;
-        return *this;
-    }
-
-    mint& operator+=(const mint& other) {
-        if ((value += other.value) >= mod) value -= mod;
-        return *this;
-    }
-
-    mint& operator-=(const mint& other) {
-        if ((value -= other.value) < 0) value += mod;
-        return *this;
-    }
-
-    mint& operator*=(const mint& other) {
-        value = (int64_t(value) * other.value) % mod;
-        return *this;
-    }
-
-    mint& operator/=(const mint& other) { return *this *= other.inverse(); }
-
-    friend mint operator+(const mint& lhs, const mint& rhs) { return (mint(lhs) += rhs); }
-
-    friend mint operator-(const mint& lhs, const mint& rhs) { return (mint(lhs) -= rhs); }
-
-    friend mint operator*(const mint& lhs, const mint& rhs) { return (mint(lhs) *= rhs); }
-
-    friend mint operator/(const mint& lhs, const mint& rhs) { return (mint(lhs) /= rhs); }
-
-    mint operator-() { return mint(-value); }
-
-    friend bool operator==(const mint& lhs, const mint& rhs) { return lhs.value == rhs.value; }
-
-    friend bool operator!=(const mint& lhs, const mint& rhs) { return lhs.value != rhs.value; }
-
-    friend bool operator<(const mint& lhs, const mint& rhs) { return lhs.value < rhs.value; }
-
-    friend bool operator>(const mint& lhs, const mint& rhs) { return lhs.value > rhs.value; }
-
-    mint& operator++() {
-        ++value;
-        if (value == mod) value = 0;
-        return *this;
-    }
-
-    mint& operator--() {
-        --value;
-        if (value == -1) value = mod - 1;
-        return *this;
-    }
-
-    mint operator++(int) {
-        mint prev = *this;
-        value++;
-        if (value == mod) value = 0;
-        return prev;
-    }
-
-    mint operator--(int) {
-        mint prev = *this;
-        value--;
-        if (value == -1) value = mod - 1;
-        return prev;
-    }
-
-    friend std::istream& operator>>(std::istream& in, mint& num) {
-        int64_t val;
-        in >> val;
-        num.value = normalize(val);
-        return in;
-    }
+namespace combinatorics {
 
-    friend std::ostream& operator<<(std::ostream& out, const mint& num) {
-        out << num.value;
-        return out;
-    }
+struct tables_t {
+    vm fact, inv_fact, inv;
 };
 
-// const int MOD = 1e9 + 7;
-const int MOD = 998244353;
-using mint = modular_int_t<MOD>;
-using vm = std::vector<mint>;
-
-// No need to run any init function, it dynamically resizes the data.
-namespace combinatorics {
-
-vm fact_, inv_fact_, inv_;
+std::atomic<const tables_t*> tables_{nullptr};
+std::mutex tables_mutex_;
+// Every published table is kept alive, so readers never see freed memory; tables grow at
+// least twice, so the history takes at most about twice the memory of the largest one
+std::vector<std::unique_ptr<const tables_t>> tables_history_;
 
-void resize_data(int n) {
-    if (fact_.empty()) {
-        fact_ = {1, 1};
-        inv_fact_ = {1, 1};
-        inv_ = {0, 1};
-    }
-    for (int cur = fact_.size(); cur <= n; ++cur) {
-        fact_.push_back(fact_.back() * cur);
-        inv_.push_back(mint(cur).inverse());
-        inv_fact_.push_back(inv_fact_.back() * inv_.back());
-    }
+/*
+ * Makes tables valid for indices 0, 1, ..., n < MOD, grows them at least twice, so growth is
+ * amortized O(1) per index
+ * Only n! is inverted, then 1 / (i - 1)! = i / i! and 1 / i = (i - 1)! / i!
+ * Complexity: O(n + log MOD)
+ */
+const tables_t& reserve(int n) {
+    const tables_t* cur = tables_.load(std::memory_order_acquire);
+    if (cur && n < static_cast<int>(cur->fact.size())) return *cur;
+    std::lock_guard<std::mutex> lock(tables_mutex_);
+    cur = tables_.load(std::memory_order_relaxed);
+    if (cur && n < static_cast<int>(cur->fact.size())) return *cur;
+    assert(n < MOD);
+    const int sz = cur ? cur->fact.size() : 0;
+    n = std::max(n, std::min(MOD - 1, 2 * sz));
+    auto next = cur ? std::make_unique<tables_t>(*cur) : std::make_unique<tables_t>();
+    vm &fact_ = next->fact, &inv_fact_ = next->inv_fact, &inv_ = next->inv;
+    int old = fact_.size();
+    fact_.resize(n + 1), inv_fact_.resize(n + 1), inv_.resize(n + 1);
+    if (old == 0) fact_[0] = inv_fact_[0] = 1, old = 1;
+    for (int i = old; i <= n; ++i) fact_[i] = fact_[i - 1] * i;
+    inv_fact_[n] = fact_[n].inverse();
+    for (int i = n; i > old; --i) inv_fact_[i - 1] = inv_fact_[i] * i;
+    for (int i = old; i <= n; ++i) inv_[i] = inv_fact_[i] * fact_[i - 1];
+    tables_.store(next.get(), std::memory_order_release);
+    tables_history_.push_back(std::move(next));
+    return *tables_history_.back();
 }
 
+// Lazy growth on access, same as reserve
+const tables_t& resize_data(int n) { return reserve(n); }
+
 struct comb_data {
-    vm& data;
+    vm tables_t::*data;
 
-    mint operator[](int i) {
-        if (i >= static_cast<int>(data.size())) resize_data(i);
-        return data[i];
+    mint operator[](int i) const {
+        const tables_t* cur = tables_.load(std::memory_order_acquire);
+        if (!cur || i >= static_cast<int>((cur->*data).size())) cur = &resize_data(i);
+        return (cur->*data)[i];
     }
-} fact(fact_), inv_fact(inv_fact_), inv(inv_);
+} fact{&tables_t::fact}, inv_fact{&tables_t::inv_fact}, inv{&tables_t::inv};
 
 /*
  * From n choose k
@@ -196,6 +109,89 @@ mint stirling2(int n, int k) {
     return res * inv_fact[k];
 }
 
+/*
+ * Row S(n, 0), S(n, 1), ..., S(n, n) of Stirling numbers of the second kind
+ * S(n, k) = sum_j (-1)^{k - j} / (k - j)! * j^n / j!, a single convolution
+ * Complexity: O(n log n)
+ */
+polynom stirling2_row(int n) {
+    const tables_t& t = resize_data(n);
+    polynom a(n + 1), b(n + 1);
+    for (int j = 0; j <= n; ++j) {
+        a[j] = mint(j).power(n) * t.inv_fact[j];
+        b[j] = j % 2 ? -t.inv_fact[j] : t.inv_fact[j];
+    }
+    polynom res = a * b;
+    res.resize(n + 1);
+    return res;
+}
+
+/*
+ * Row c(n, 0), c(n, 1), ..., c(n, n) of unsigned Stirling numbers of the first kind,
+ * signed ones are (-1)^{n - k} c(n, k)
+ * Permutations of n elements with exactly k cycles, sum_k c(n, k) x^k = x (x + 1) ... (x + n - 1)
+ * Doubling: P_{2m}(x) = P_m(x) * P_m(x + m), P_{m + 1}(x) = P_m(x) * (x + m)
+ * Complexity: O(n log n)
+ */
+polynom stirling1_row(int n) {
+    polynom res(1, 1);
+    for (int bit = n ? 31 - __builtin_clz(n) : -1; bit >= 0; --bit) {
+        int m = res.size() - 1;
+        res = res * res.taylor_shift(m);
+        if (n >> bit & 1) {
+            m *= 2;
+            res.resize(m + 2);
+            for (int i = m + 1; i > 0; --i) res[i] = res[i - 1] + res[i] * m;
+            res[0] *= m;
+        }
+    }
+    return res;
+}
+
+/*
+ * Bell numbers B_0, B_1, ..., B_n, partitions of a set into nonempty groups
+ * EGF: e^{e^x - 1}
+ * Complexity: O(n log n)
+ */
+polynom bell_numbers(int n) {
+    const tables_t& t = resize_data(n);
+    polynom f(n + 1);
+    for (int i = 1; i <= n; ++i) f[i] = t.inv_fact[i];
+    polynom res = f.exp(n + 1);
+    for (int i = 0; i <= n; ++i) res[i] *= t.fact[i];
+    return res;
+}
+
+/*
+ * Partition numbers p_0, p_1, ..., p_n, ways to write n as an unordered sum of positive integers
+ * GF: 1 / prod_k (1 - x^k), denominator is sum_k (-1)^k x^{k(3k - 1) / 2} by pentagonal theorem
+ * Complexity: O(n log n)
+ */
+polynom partition_numbers(int n) {
+    polynom euler(n + 1);
+    euler[0] = 1;
+    for (int k = 1; k * (3 * k - 1) / 2 <= n; ++k) {
+        mint sgn = k % 2 ? -1 : 1;
+        euler[k * (3 * k - 1) / 2] += sgn;
+        if (k * (3 * k + 1) / 2 <= n) euler[k * (3 * k + 1) / 2] += sgn;
+    }
+    return euler.inverse(n + 1);
+}
+
+/*
+ * Bernoulli numbers B_0, B_1, ..., B_n, B_1 = -1 / 2
+ * EGF: x / (e^x - 1), its inverse is sum_i x^i / (i + 1)!
+ * Complexity: O(n log n)
+ */
+polynom bernoulli_numbers(int n) {
+    const tables_t& t = resize_data(n + 1);
+    polynom f(n + 1);
+    for (int i = 0; i <= n; ++i) f[i] = t.inv_fact[i + 1];
+    polynom res = f.inverse(n + 1);
+    for (int i = 0; i <= n; ++i) res[i] *= t.fact[i];
+    return res;
+}
+
 };  // namespace combinatorics
 
 using namespace combinatorics;
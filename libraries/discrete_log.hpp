@@ -0,0 +1,193 @@
+#ifndef DISCRETE_LOG
+#define DISCRETE_LOG
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "modular.hpp"
+
+/*
+ * Open addressing hash table from values < 2^32 - 1 to int, linear probing
+ * Keys are only inserted, capacity is fixed at construction
+ */
+struct flat_table_t {
+    static constexpr uint32_t EMPTY = ~0u;
+
+    std::vector<uint32_t> keys;
+    std::vector<int> vals;
+    uint32_t mask;
+    int shift;
+
+    explicit flat_table_t(int n) {
+        int lg = 1;
+        while ((1 << lg) < 2 * n) ++lg;
+        keys.assign(1 << lg, EMPTY), vals.resize(1 << lg);
+        mask = (1u << lg) - 1, shift = 32 - lg;
+    }
+
+    uint32_t slot(uint32_t key) const { return (key * 0x9E3779B9u) >> shift; }
+
+    // Keeps the old value if key is present
+    void insert(uint32_t key, int val) {
+        uint32_t i = slot(key);
+        for (; keys[i] != EMPTY; i = (i + 1) & mask)
+            if (keys[i] == key) return;
+        keys[i] = key, vals[i] = val;
+    }
+
+    // Value by key or -1
+    int find(uint32_t key) const {
+        for (uint32_t i = slot(key); keys[i] != EMPTY; i = (i + 1) & mask)
+            if (keys[i] == key) return vals[i];
+        return -1;
+    }
+};
+
+/*
+ * Baby-step giant-step for a fixed base a coprime with the prime modulus
+ * Table stores a^j -> j for j < m, a query takes about n / m giant steps, so for q queries
+ * m = sqrt(n * q) balances building and answering
+ * Complexity: O(m) to build, O(n / m) per query
+ */
+template <class mint>
+struct bsgs_t {
+    int64_t n;
+    int m;
+    mint giant;
+    flat_table_t table;
+
+    // Searches logarithms in [0, n), n = mod - 1 covers any order of a
+    explicit bsgs_t(mint a, int64_t n = mint::get_mod() - 1, int m = 0)
+        : n(n), m(m > 0 ? m : std::max<int>(1, std::ceil(std::sqrt(static_cast<double>(n))))),
+          table(this->m) {
+        mint cur = 1;
+        for (int j = 0; j < this->m; ++j, cur *= a) table.insert(cur.val(), j);
+        giant = cur.inverse();
+    }
+
+    // Smallest x in [0, n) with a^x = b, or -1
+    int64_t log(mint b) const {
+        for (int64_t i = 0; i * m < n; ++i, b *= giant) {
+            int j = table.find(b.val());
+            if (j != -1) return i * m + j < n ? i * m + j : -1;
+        }
+        return -1;
+    }
+};
+
+/*
+ * Smallest x >= 0 with a^x = b, or -1, the modulus must be prime and a nonzero
+ * Complexity: O(sqrt(mod))
+ */
+template <class mint>
+int64_t discrete_log(mint a, mint b) {
+    return bsgs_t<mint>(a).log(b);
+}
+
+/*
+ * Square root modulo an odd prime, Tonelli-Shanks, returns false if a is a non-residue
+ * p - 1 = 2^s t, z is a non-residue; r = a^{(t + 1) / 2} is fixed by powers of z until
+ * r^2 / a = a^t becomes 1
+ * Complexity: O(log^2 mod)
+ */
+template <class mint>
+bool sqrt_mod(mint a, mint& res) {
+    const int64_t p = mint::get_mod();
+    if (a == 0 || p == 2) return res = a, true;
+    if (a.power((p - 1) / 2) != 1) return false;
+    int s = __builtin_ctzll(p - 1);
+    int64_t t = (p - 1) >> s;
+    mint z = 2;
+    while (z.power((p - 1) / 2) == 1) z += 1;
+    mint c = z.power(t), r = a.power((t + 1) / 2), x = a.power(t);
+    while (x != 1) {
+        int i = 0;
+        for (mint y = x; y != 1; y *= y) ++i;
+        for (int j = 0; j < s - i - 1; ++j) c *= c;
+        r *= c, c *= c, x *= c, s = i;
+    }
+    res = r;
+    return true;
+}
+
+// x^{-1} mod m for coprime x and m, 0 for m = 1, extended Euclidean algorithm
+int64_t inverse_mod_(int64_t x, int64_t m) {
+    int64_t x0 = 1, x1 = 0, r0 = x, r1 = m;
+    while (r1) {
+        int64_t q = r0 / r1;
+        std::swap(r0 -= q * r1, r1), std::swap(x0 -= q * x1, x1);
+    }
+    return m == 1 ? 0 : (x0 % m + m) % m;
+}
+
+/*
+ * (q^e)-th root of a modulo prime p for prime q, q^e dividing p - 1, a must be a residue
+ * q-th roots are taken e times, any q-th root of a q^{i+1}-th power residue is a q^i-th power
+ * residue because q^{i+1} divides p - 1
+ * Adleman-Manders-Miller: p - 1 = q^s t, alpha = q^{-1} mod t, a^alpha is a q-th root up to
+ * a factor of order dividing q^{s-1}, which is removed digit by digit with discrete logs
+ * in the subgroup of order q
+ * Complexity: O(e s log p + sqrt(q) + e s sqrt(q))
+ */
+template <class mint>
+mint prime_power_root_(mint a, int64_t q, int e) {
+    const int64_t p1 = mint::get_mod() - 1;
+    int s = 0;
+    int64_t t = p1;
+    while (t % q == 0) t /= q, ++s;
+    const int64_t alpha = inverse_mod_(q % t, t);
+    mint rho = 2;
+    while (rho.power(p1 / q) == 1) rho += 1;
+    int64_t qs1 = 1;
+    for (int i = 0; i < s - 1; ++i) qs1 *= q;
+    // c_i = rho^{t q^i}
+    std::vector<mint> c(s + 1);
+    c[0] = rho.power(t);
+    for (int i = 1; i <= s; ++i) c[i] = c[i - 1].power(q);
+    const bsgs_t<mint> dlog(c[s - 1], q);
+    for (; e > 0; --e) {
+        mint b = a.power((q * alpha + p1 - 1) % p1), h = 1;
+        for (int64_t i = 1, qi = qs1; i < s; ++i) {
+            qi /= q;
+            mint d = b.power(qi);
+            int64_t j = d == 1 ? 0 : (q - dlog.log(d)) % q;
+            b *= c[i].power(j), h *= c[i - 1].power(j);
+        }
+        a = a.power(alpha) * h;
+    }
+    return a;
+}
+
+/*
+ * Some x with x^k = a modulo prime, returns false if there is none
+ * With d = gcd(k, p - 1) and u = (k / d)^{-1} mod (p - 1) / d the task becomes d-th root of a^u,
+ * which is taken one prime factor of d at a time
+ * Complexity: O(sqrt(d) + log^2 mod) for smooth d
+ */
+template <class mint, class T>
+bool kth_root(mint a, T k, mint& res) {
+    static_assert(std::is_integral<T>::value);
+    assert(k >= 0);
+    const int64_t p1 = mint::get_mod() - 1;
+    if (k == 0) return res = 1, a == 1;
+    if (a == 0) return res = 0, true;
+    int64_t kk = k % p1, d = std::gcd(kk, p1);
+    if (kk == 0) kk = p1, d = p1;
+    if (a.power(p1 / d) != 1) return false;
+    res = a.power(inverse_mod_(kk / d % (p1 / d), p1 / d));
+    for (int64_t q = 2; q * q <= d; ++q) {
+        int e = 0;
+        for (; d % q == 0; d /= q) ++e;
+        if (e) res = prime_power_root_(res, q, e);
+    }
+    if (d > 1) res = prime_power_root_(res, d, 1);
+    return true;
+}
+
+#endif /* DISCRETE_LOG */
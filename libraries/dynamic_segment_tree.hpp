@@ -0,0 +1,155 @@
+#ifndef DYNAMIC_SEGMENT_TREE
+#define DYNAMIC_SEGMENT_TREE
+
+#include <algorithm>
+#include <cstdint>
+
+#include "chunked_arena.hpp"
+
+/**
+ * Implicit segment tree over a huge coordinate range [minl, maxr)
+ * sum on segment, add val on segment
+ * Nodes are created on first touch by an update, queries do not create nodes
+ * Nodes live in a chunked_arena_t, children are 32-bit indices and 0 is null
+ * Intervals is expected to be [l, r)
+ * T is node type, D is delay type
+ * Complexity: O(log(maxr - minl)) per operation, at most 4 new nodes per level
+ */
+template <class T, class D>
+class dynamic_segment_tree_t {
+   private:
+    struct node_t {
+        uint32_t left, right;
+        T val;
+        D delay;
+    };
+
+    int64_t minl, maxr;
+    uint32_t root;
+    chunked_arena_t<node_t> arena;
+
+    node_t& at(uint32_t u) { return arena[u]; }
+
+    // Node for an untouched segment of len elements
+    uint32_t create(int64_t len) { return arena.create(node_t{0, 0, initial(len), nulldel}); }
+
+    void apply_to_node(uint32_t u, const D& val, int64_t len) {
+        node_t& v = at(u);
+        apply_to_val(v.val, val, len);
+        apply_to_del(v.delay, val);
+    }
+
+    void push(uint32_t u, int64_t lo, int64_t hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (!at(u).left) {
+            uint32_t left = create(mid - lo), right = create(hi - mid);
+            at(u).left = left, at(u).right = right;
+        }
+        node_t& v = at(u);
+        if (v.delay == nulldel) return;
+        apply_to_node(v.left, v.delay, mid - lo);
+        apply_to_node(v.right, v.delay, hi - mid);
+        v.delay = nulldel;
+    }
+
+    void pull(uint32_t u) {
+        node_t& v = at(u);
+        v.val = f(at(v.left).val, at(v.right).val);
+    }
+
+    T get(uint32_t u, int64_t lo, int64_t hi, int64_t l, int64_t r) {
+        if (r <= lo || hi <= l) return nullval;
+        if (l <= lo && hi <= r) return at(u).val;
+        if (!at(u).left) {
+            // An unsplit node has only received whole-node updates, its elements are equal
+            T res = initial(std::min(r, hi) - std::max(l, lo));
+            apply_to_val(res, at(u).delay, std::min(r, hi) - std::max(l, lo));
+            return res;
+        }
+        push(u, lo, hi);
+        int64_t mid = lo + (hi - lo) / 2;
+        return f(get(at(u).left, lo, mid, l, r), get(at(u).right, mid, hi, l, r));
+    }
+
+    void upd(uint32_t u, int64_t lo, int64_t hi, int64_t l, int64_t r, const D& val) {
+        if (r <= lo || hi <= l) return;
+        if (l <= lo && hi <= r) {
+            apply_to_node(u, val, hi - lo);
+            return;
+        }
+        push(u, lo, hi);
+        int64_t mid = lo + (hi - lo) / 2;
+        upd(at(u).left, lo, mid, l, r, val);
+        upd(at(u).right, mid, hi, l, r, val);
+        pull(u);
+    }
+
+    void set(uint32_t u, int64_t lo, int64_t hi, int64_t pos, const T& val) {
+        if (lo + 1 == hi) {
+            at(u).val = val;
+            return;
+        }
+        push(u, lo, hi);
+        int64_t mid = lo + (hi - lo) / 2;
+        if (pos < mid)
+            set(at(u).left, lo, mid, pos, val);
+        else
+            set(at(u).right, mid, hi, pos, val);
+        pull(u);
+    }
+
+    // Copies the subtree of u from old arena in preorder, returns its new index
+    uint32_t copy_preorder(const chunked_arena_t<node_t>& old, uint32_t u) {
+        const node_t& src = old[u];
+        uint32_t v = arena.create(src);
+        if (src.left) {
+            uint32_t left = copy_preorder(old, src.left);
+            uint32_t right = copy_preorder(old, src.right);
+            at(v).left = left, at(v).right = right;
+        }
+        return v;
+    }
+
+   public:
+    constexpr static T nullval = 0;
+
+    // Function on inverval
+    T f(const T& x, const T& y) { return x + y; }
+
+    constexpr static D nulldel = 0;
+
+    // Value of an untouched segment of len elements
+    T initial(int64_t) { return nullval; }
+
+    // Apply delayed value to interval of len elements
+    void apply_to_val(T& x, const D& y, int64_t len) { x += y * len; }
+
+    // Update delayed value
+    void apply_to_del(D& x, const D& y) { x += y; }
+
+    dynamic_segment_tree_t(int64_t minl, int64_t maxr) : minl(minl), maxr(maxr) {
+        root = create(maxr - minl);
+    }
+
+    // Get f of elements on segment [l, r)
+    T get(int64_t l, int64_t r) { return get(root, minl, maxr, l, r); }
+
+    // Modify value on segment [l, r) by val
+    void upd(int64_t l, int64_t r, const D& val) { upd(root, minl, maxr, l, r, val); }
+
+    // Set value at position pos to val
+    void set(int64_t pos, const T& val) { set(root, minl, maxr, pos, val); }
+
+    // Number of materialized nodes
+    size_t node_count() const { return arena.size(); }
+
+    // Renumbers nodes in DFS preorder into a fresh arena, so that a subtree is contiguous
+    // and a left child follows its parent; call after a bulk load
+    void compact() {
+        chunked_arena_t<node_t> old;
+        old.swap(arena);
+        root = copy_preorder(old, root);
+    }
+};
+
+#endif /* DYNAMIC_SEGMENT_TREE */
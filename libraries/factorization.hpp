@@ -0,0 +1,133 @@
+#ifndef FACTORIZATION
+#define FACTORIZATION
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "modular.hpp"
+
+/*
+ * Deterministic Miller-Rabin for n < 2^62, the 7 bases are known to be enough for all n < 2^64
+ * Complexity: O(log n) Montgomery multiplications per base
+ */
+bool is_prime(uint64_t n) {
+    if (n < 2) return false;
+    for (uint64_t p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37})
+        if (n % p == 0) return n == p;
+    if (n < 41 * 41) return true;
+    const montgomery64_t mt(n);
+    const uint64_t one = mt.to(1), minus_one = mt.to(n - 1);
+    const int s = __builtin_ctzll(n - 1);
+    const uint64_t d = (n - 1) >> s;
+    // Bases 2, 7, 61 are enough for n < 2^32
+    const bool small = n < (1ULL << 32);
+    for (uint64_t a : {2, 325, 9375, 28178, 450775, 9780504, 1795265022, 7, 61}) {
+        if (small != (a == 2 || a == 7 || a == 61)) continue;
+        if (a % n == 0) continue;
+        uint64_t x = mt.power(mt.to(a), d);
+        if (x == one || x == minus_one) continue;
+        bool composite = true;
+        for (int i = 1; i < s && composite; ++i) {
+            x = mt.mul(x, x);
+            composite = x != minus_one;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+/*
+ * Brent's cycle search for x -> f(x) starting at y, diff(x, y) is a multiple of x - y mod n
+ * Differences are multiplied in batches of RHO_BATCH_, one gcd per batch, the last batch
+ * is replayed one step at a time if the gcd jumps to n; returns n on failure
+ */
+constexpr int RHO_BATCH_ = 128;
+
+template <class F, class Mul, class Diff>
+uint64_t brent_(uint64_t n, uint64_t y, uint64_t q, F f, Mul mul, Diff diff) {
+    uint64_t x = y, ys = y, g = 1;
+    for (uint64_t r = 1; g == 1; r *= 2) {
+        x = y;
+        for (uint64_t i = 0; i < r; ++i) y = f(y);
+        for (uint64_t k = 0; k < r && g == 1; k += RHO_BATCH_) {
+            ys = y;
+            for (uint64_t i = 0; i < std::min<uint64_t>(RHO_BATCH_, r - k); ++i) {
+                y = f(y);
+                q = mul(q, diff(x, y));
+            }
+            // q is in Montgomery form, 2^64 is coprime with n, so the gcd is the same
+            g = std::gcd(q, n);
+        }
+    }
+    if (g == n) {
+        do {
+            ys = f(ys);
+            g = std::gcd(diff(x, ys), n);
+        } while (g == 1);
+    }
+    return g;
+}
+
+/*
+ * Some nontrivial divisor of odd composite n < 2^62, Brent's variant of Pollard's rho
+ * with f(x) = x^2 + c in Montgomery form
+ * For n < 2^60 the sequence is kept in (0, 3n) without final reductions, every product is then
+ * below 12n^2 < n * 2^64 as reduce_lazy requires
+ * Complexity: O(n^{1/4}) expected Montgomery multiplications
+ */
+uint64_t pollard_rho(uint64_t n) {
+    if (n % 2 == 0) return 2;
+    const montgomery64_t mt(n);
+    for (uint64_t c0 = 1;; ++c0) {
+        const uint64_t c = mt.to(c0), y = mt.to(2), one = mt.to(1);
+        uint64_t g;
+        if (n < (1ULL << 60)) {
+            g = brent_(
+                n, y, one,
+                [&](uint64_t v) { return mt.reduce_lazy(static_cast<unsigned __int128>(v) * v) + c; },
+                [&](uint64_t u, uint64_t v) {
+                    return mt.reduce_lazy(static_cast<unsigned __int128>(u) * v);
+                },
+                [&](uint64_t u, uint64_t v) { return u + 3 * n - v; });
+        } else {
+            g = brent_(
+                n, y, one, [&](uint64_t v) { return mt.add(mt.mul(v, v), c); },
+                [&](uint64_t u, uint64_t v) { return mt.mul(u, v); },
+                [&](uint64_t u, uint64_t v) { return mt.sub(u, v); });
+        }
+        if (g != n) return g;
+    }
+}
+
+constexpr uint64_t SMALL_PRIMES_[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61};
+
+/*
+ * Prime factors of n < 2^62 in nondecreasing order, with multiplicity
+ * Small factors are removed by trial division, the rest is split by Pollard's rho
+ * Complexity: O(n^{1/4} log n) expected
+ */
+std::vector<uint64_t> factorize(uint64_t n) {
+    std::vector<uint64_t> res;
+    for (uint64_t p : SMALL_PRIMES_) {
+        if (p * p > n) break;
+        while (n % p == 0) res.push_back(p), n /= p;
+    }
+    std::vector<uint64_t> stack;
+    if (n > 1) stack.push_back(n);
+    while (!stack.empty()) {
+        uint64_t x = stack.back();
+        stack.pop_back();
+        if (is_prime(x)) {
+            res.push_back(x);
+            continue;
+        }
+        uint64_t d = pollard_rho(x);
+        stack.push_back(d), stack.push_back(x / d);
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+#endif /* FACTORIZATION */
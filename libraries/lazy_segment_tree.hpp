@@ -52,7 +52,7 @@ class lazy_segment_tree_t {
 
     void upd(int id, int lo, int hi, int l, int r, const D& val) {
         if (r <= lo || hi <= l) return;
-        if (l <= lo && hi <= r) {
+        if (l <= lo && hi <= r && (lo + 1 == hi || can_apply(tr[id], val))) {
             apply_to_node(id, val);
             return;
         }
@@ -90,6 +90,10 @@ class lazy_segment_tree_t {
     // Update delayed value
     void apply_to_del(D& x, const D& y) { x += y; }
 
+    // Whether val can be applied to a whole inner node as a tag, otherwise upd recurses
+    // into its children; T has to carry whatever the check needs
+    bool can_apply(const T&, const D&) { return true; }
+
     lazy_segment_tree_t(int n) : n(n), tr(4 * n), delay(4 * n, nulldel) {}
 
     lazy_segment_tree_t(const std::vector<T>& vec) : lazy_segment_tree_t(vec.size()) {
@@ -47,6 +47,18 @@ class lazy_segment_tree_t {
         for (int d = h; d > 0; --d) push(pos >> d);
     }
 
+    // Canonical nodes of [l, r) from left to right, returns their count, res holds up to 64 nodes
+    // Each of them is a root of a perfect subtree of leaves, so it can be descended into
+    int nodes_of(int l, int r, int* res) const {
+        int cnt = 0, rcnt = 0, rev[32];
+        for (l += n, r += n; l < r; l /= 2, r /= 2) {
+            if (l & 1) res[cnt++] = l++;
+            if (r & 1) rev[rcnt++] = --r;
+        }
+        while (rcnt > 0) res[cnt++] = rev[--rcnt];
+        return cnt;
+    }
+
     // Update node values on route from pos node to root
     void apply_from_leaf(int pos) {
         for (pos += n; pos > 1; pos /= 2) {
@@ -105,6 +117,66 @@ class lazy_segment_tree_t {
         apply_from_leaf(l0), apply_from_leaf(r0 - 1);
     }
 
+    /*
+     * Largest r >= l with pred(f of [l, r)) true, pred must be monotone and pred(nullval) true
+     * Delays above the canonical nodes of [l, n) are pushed first, then they are scanned
+     * left to right and the first failing one is descended into, pushing on the way
+     * Complexity: O(log n)
+     */
+    template <class Pred>
+    int max_right(int l, Pred pred) {
+        clamp(l);
+        if (l == n) return n;
+        apply_from_root(l), apply_from_root(n - 1);
+        int nodes[64], cnt = nodes_of(l, n, nodes);
+        T acc = nullval;
+        for (int i = 0; i < cnt; ++i) {
+            int v = nodes[i];
+            T nxt = f(acc, tr[v]);
+            if (pred(nxt)) {
+                acc = nxt;
+                continue;
+            }
+            while (v < n) {
+                push(v);
+                v *= 2;
+                nxt = f(acc, tr[v]);
+                if (pred(nxt)) acc = nxt, ++v;
+            }
+            return v - n;
+        }
+        return n;
+    }
+
+    /*
+     * Smallest l <= r with pred(f of [l, r)) true, pred must be monotone and pred(nullval) true
+     * Complexity: O(log n)
+     */
+    template <class Pred>
+    int min_left(int r, Pred pred) {
+        clamp(r);
+        if (r == 0) return 0;
+        apply_from_root(0), apply_from_root(r - 1);
+        int nodes[64], cnt = nodes_of(0, r, nodes);
+        T acc = nullval;
+        for (int i = cnt - 1; i >= 0; --i) {
+            int v = nodes[i];
+            T nxt = f(tr[v], acc);
+            if (pred(nxt)) {
+                acc = nxt;
+                continue;
+            }
+            while (v < n) {
+                push(v);
+                v = v * 2 + 1;
+                nxt = f(tr[v], acc);
+                if (pred(nxt)) acc = nxt, --v;
+            }
+            return v + 1 - n;
+        }
+        return 0;
+    }
+
     // Set value at position pos to val
     void set(int pos, const T& val) {
         apply_from_root(pos);
@@ -0,0 +1,355 @@
+#ifndef MATRIX
+#define MATRIX
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "modular.hpp"
+
+/*
+ * Dense matrix over mint with contiguous row-major storage
+ * mint must provide lazy reduction: LAZY_CNT, raw() and from_lazy()
+ * (modular_int_t, montgomery_int_t, dynamic_modular_int_t)
+ */
+template <class mint>
+struct matrix {
+    using vm = std::vector<mint>;
+
+    int n, m;
+    vm data;
+
+    matrix() : n(0), m(0) {}
+    matrix(int n, int m) : n(n), m(m), data(static_cast<size_t>(n) * m) {}
+    matrix(const std::vector<vm>& rows) : matrix(rows.size(), rows.empty() ? 0 : rows[0].size()) {
+        for (int i = 0; i < n; ++i) std::copy(rows[i].begin(), rows[i].end(), (*this)[i]);
+    }
+
+    static matrix identity(int n) {
+        matrix res(n, n);
+        for (int i = 0; i < n; ++i) res[i][i] = 1;
+        return res;
+    }
+
+    mint* operator[](int i) { return data.data() + static_cast<size_t>(i) * m; }
+    const mint* operator[](int i) const { return data.data() + static_cast<size_t>(i) * m; }
+
+    matrix& operator+=(const matrix& rhs) {
+        assert(n == rhs.n && m == rhs.m);
+        for (size_t i = 0; i < data.size(); ++i) data[i] += rhs.data[i];
+        return *this;
+    }
+
+    matrix& operator-=(const matrix& rhs) {
+        assert(n == rhs.n && m == rhs.m);
+        for (size_t i = 0; i < data.size(); ++i) data[i] -= rhs.data[i];
+        return *this;
+    }
+
+    matrix& operator*=(mint lambda) {
+        for (auto& x : data) x *= lambda;
+        return *this;
+    }
+
+    friend matrix operator+(const matrix& lhs, const matrix& rhs) { return matrix(lhs) += rhs; }
+
+    friend matrix operator-(const matrix& lhs, const matrix& rhs) { return matrix(lhs) -= rhs; }
+
+    friend matrix operator*(mint lambda, const matrix& a) { return matrix(a) *= lambda; }
+
+    friend bool operator==(const matrix& lhs, const matrix& rhs) {
+        return lhs.n == rhs.n && lhs.m == rhs.m && lhs.data == rhs.data;
+    }
+
+    friend bool operator!=(const matrix& lhs, const matrix& rhs) { return !(lhs == rhs); }
+
+    // Columns of B processed at once, the tile of B and the accumulators stay in cache
+    constexpr static int TILE_ = 256;
+
+    /*
+     * Computes res = lhs * rhs, res must not alias lhs or rhs, its storage is reused
+     * Products of raw values are summed in uint64_t and reduced once per LAZY_CNT terms
+     * Complexity: O(nmk)
+     */
+    friend void multiply(const matrix& lhs, const matrix& rhs, matrix& res) {
+        assert(lhs.m == rhs.n && &res != &lhs && &res != &rhs);
+        const int n = lhs.n, k = lhs.m, m = rhs.m;
+        res.n = n, res.m = m;
+        res.data.resize(static_cast<size_t>(n) * m);
+        const uint64_t mod = mint::get_mod();
+        uint64_t acc[TILE_];
+        for (int j0 = 0; j0 < m; j0 += TILE_) {
+            const int w = std::min(TILE_, m - j0);
+            for (int i = 0; i < n; ++i) {
+                std::fill(acc, acc + w, 0);
+                const mint* a = lhs[i];
+                for (int t0 = 0; t0 < k; t0 += mint::LAZY_CNT) {
+                    const int t1 = std::min(k, t0 + mint::LAZY_CNT);
+                    for (int t = t0; t < t1; ++t) {
+                        const uint64_t x = a[t].raw();
+                        const mint* b = rhs[t] + j0;
+                        for (int j = 0; j < w; ++j) acc[j] += x * b[j].raw();
+                    }
+                    for (int j = 0; j < w; ++j) acc[j] %= mod;
+                }
+                mint* c = res[i] + j0;
+                for (int j = 0; j < w; ++j) c[j] = mint::from_lazy(acc[j]);
+            }
+        }
+    }
+
+    friend matrix operator*(const matrix& lhs, const matrix& rhs) {
+        matrix res;
+        multiply(lhs, rhs, res);
+        return res;
+    }
+
+    matrix& operator*=(const matrix& rhs) { return *this = *this * rhs; }
+
+    /*
+     * Matrix-vector product a * v
+     * Complexity: O(nm)
+     */
+    friend vm operator*(const matrix& a, const vm& v) {
+        assert(a.m == static_cast<int>(v.size()));
+        vm res(a.n);
+        for (int i = 0; i < a.n; ++i) res[i] = dot_product(a[i], v.data(), a.m);
+        return res;
+    }
+
+    /*
+     * Computes this ^ y, only three buffers are allocated
+     * Complexity: O(n^3 log y)
+     */
+    template <class T>
+    matrix power(T y) const {
+        static_assert(std::is_integral<T>::value);
+        assert(n == m && y >= 0);
+        matrix res = identity(n), base(*this), tmp(n, n);
+        for (; y > 0; y >>= 1) {
+            if (y & 1) multiply(res, base, tmp), std::swap(res, tmp);
+            if (y > 1) multiply(base, base, tmp), std::swap(base, tmp);
+        }
+        return res;
+    }
+
+    /*
+     * Gaussian elimination over prime field on the first cols columns, returns rank
+     * reduced = true gives reduced row echelon form (Gauss-Jordan), det gets the determinant
+     * of the leading square block if cols = n
+     * Pivots are found in panels of LAZY_CNT columns, the panel columns are eliminated at once
+     * and the rest of every row gets all LAZY_CNT updates of the panel in one pass:
+     * products are summed in uint64_t and reduced once, the row is read from memory once
+     * Complexity: O(n m min(n, cols))
+     */
+    int gauss(int cols, bool reduced, mint* det = nullptr) {
+        constexpr int B = mint::LAZY_CNT;
+        const uint64_t mod = mint::get_mod();
+        std::vector<uint64_t> t(data.size()), coef(static_cast<size_t>(n) * B);
+        for (size_t i = 0; i < data.size(); ++i) t[i] = data[i].val();
+        auto row = [&](int i) { return t.data() + static_cast<size_t>(i) * m; };
+        auto coefs = [&](int i) { return coef.data() + static_cast<size_t>(i) * B; };
+        uint64_t det_val = 1;
+        int rank = 0;
+        for (int c0 = 0; c0 < cols && rank < n; c0 += B) {
+            const int c1 = std::min(cols, c0 + B), r0 = rank;
+            for (int c = c0; c < c1 && rank < n; ++c) {
+                int piv = rank;
+                while (piv < n && row(piv)[c] == 0) ++piv;
+                if (piv == n) {
+                    det_val = 0;
+                    continue;
+                }
+                if (piv != rank) {
+                    std::swap_ranges(row(piv), row(piv) + m, row(rank));
+                    std::swap_ranges(coefs(piv), coefs(piv) + B, coefs(rank));
+                    det_val = det_val ? mod - det_val : 0;
+                }
+                // Brings the rest of the pivot row up to date with the earlier panel pivots
+                uint64_t *p = row(rank), *pc = coefs(rank);
+                for (int s = 0; s < rank - r0; ++s) {
+                    const uint64_t x = pc[s], *q = row(r0 + s);
+                    if (x == 0) continue;
+                    for (int j = c1; j < m; ++j) p[j] += x * q[j];
+                    pc[s] = 0;
+                }
+                for (int j = c1; j < m; ++j) p[j] %= mod;
+                det_val = det_val * p[c] % mod;
+                uint64_t inv = pow_mod(p[c], mod - 2, mod);
+                if (reduced) {
+                    for (int j = c; j < m; ++j) p[j] = p[j] * inv % mod;
+                    inv = 1;
+                }
+                for (int i = reduced ? 0 : rank + 1; i < n; ++i) {
+                    uint64_t* r = row(i);
+                    if (i == rank || r[c] == 0) continue;
+                    const uint64_t x = (mod - r[c]) * inv % mod;
+                    for (int j = c; j < c1; ++j) r[j] = (r[j] + x * p[j]) % mod;
+                    coefs(i)[rank - r0] = x;
+                }
+                ++rank;
+            }
+            // Delayed updates of columns after the panel, each pivot row must be used as it was
+            // when chosen, so pivot rows of the panel are updated last, in increasing order
+            auto flush = [&](int i) {
+                uint64_t *r = row(i), *rc = coefs(i), x[B];
+                const uint64_t* q[B];
+                int cnt = 0;
+                for (int s = 0; s < rank - r0; ++s)
+                    if (rc[s]) x[cnt] = rc[s], q[cnt++] = row(r0 + s), rc[s] = 0;
+                if (cnt == 0) return;
+                int s = 0;
+                for (; s + 4 <= cnt; s += 4) {
+                    const uint64_t *q0 = q[s], *q1 = q[s + 1], *q2 = q[s + 2], *q3 = q[s + 3];
+                    for (int j = c1; j < m; ++j)
+                        r[j] += x[s] * q0[j] + x[s + 1] * q1[j] + x[s + 2] * q2[j] + x[s + 3] * q3[j];
+                }
+                for (; s < cnt; ++s)
+                    for (int j = c1; j < m; ++j) r[j] += x[s] * q[s][j];
+                for (int j = c1; j < m; ++j) r[j] %= mod;
+            };
+            for (int i = reduced ? 0 : rank; i < n; ++i)
+                if (i < r0 || i >= rank) flush(i);
+            if (reduced)
+                for (int i = r0; i < rank; ++i) flush(i);
+        }
+        if (rank < cols) det_val = 0;
+        for (size_t i = 0; i < data.size(); ++i) data[i] = mint(static_cast<int64_t>(t[i]));
+        if (det) *det = mint(static_cast<int64_t>(det_val));
+        return rank;
+    }
+
+    // Complexity: O(n m min(n, m))
+    int rank() const { return matrix(*this).gauss(m, false); }
+
+    // Complexity: O(n^3)
+    mint det() const {
+        assert(n == m);
+        mint res;
+        matrix(*this).gauss(n, false, &res);
+        return res;
+    }
+
+    /*
+     * Inverse of a square matrix, returns false if it is singular
+     * Complexity: O(n^3)
+     */
+    bool inverse(matrix& res) const {
+        assert(n == m);
+        matrix aug(n, 2 * n);
+        for (int i = 0; i < n; ++i) {
+            std::copy((*this)[i], (*this)[i] + n, aug[i]);
+            aug[i][n + i] = 1;
+        }
+        if (aug.gauss(n, true) < n) return false;
+        res = matrix(n, n);
+        for (int i = 0; i < n; ++i) std::copy(aug[i] + n, aug[i] + 2 * n, res[i]);
+        return true;
+    }
+
+    /*
+     * Finds some x with this * x = b, free variables are set to 0, returns false if there
+     * is no solution
+     * Complexity: O(n m min(n, m))
+     */
+    bool solve(const vm& b, vm& x) const {
+        assert(n == static_cast<int>(b.size()));
+        matrix aug(n, m + 1);
+        for (int i = 0; i < n; ++i) {
+            std::copy((*this)[i], (*this)[i] + m, aug[i]);
+            aug[i][m] = b[i];
+        }
+        int rank = aug.gauss(m, true);
+        for (int i = rank; i < n; ++i)
+            if (aug[i][m] != 0) return false;
+        x.assign(m, 0);
+        for (int i = 0, j = 0; i < rank; ++i) {
+            while (aug[i][j] == 0) ++j;
+            x[j] = aug[i][m];
+        }
+        return true;
+    }
+
+    matrix transpose() const {
+        matrix res(m, n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < m; ++j) res[j][i] = (*this)[i][j];
+        return res;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const matrix& a) {
+        for (int i = 0; i < a.n; ++i) {
+            for (int j = 0; j < a.m; ++j) {
+                if (j) out << ' ';
+                out << a[i][j];
+            }
+            out << '\n';
+        }
+        return out;
+    }
+};
+
+/*
+ * Linear basis of 64-bit words over GF(2), basis[b] has the highest set bit b or is zero
+ */
+struct xor_basis {
+    uint64_t basis[64] = {};
+    int size = 0;
+
+    // Reduces x by the basis, the result is zero iff x is in the span
+    uint64_t reduce(uint64_t x) const {
+        for (int b = 63; b >= 0 && x; --b)
+            if (x >> b & 1) x ^= basis[b];
+        return x;
+    }
+
+    // Returns false if x is already in the span
+    bool insert(uint64_t x) {
+        for (int b = 63; b >= 0 && x; --b) {
+            if (!(x >> b & 1)) continue;
+            if (!basis[b]) {
+                basis[b] = x, ++size;
+                return true;
+            }
+            x ^= basis[b];
+        }
+        return false;
+    }
+
+    bool contains(uint64_t x) const { return reduce(x) == 0; }
+
+    // Maximum of x ^ y over y in the span
+    uint64_t max_xor(uint64_t x = 0) const {
+        for (int b = 63; b >= 0; --b) x = std::max(x, x ^ basis[b]);
+        return x;
+    }
+};
+
+/*
+ * Gauss-Jordan elimination over GF(2), rows are bitsets of cols bits packed into 64-bit words,
+ * bit j of a row is a[i][j / 64] >> (j % 64) & 1; returns rank, a becomes reduced row echelon form
+ * Complexity: O(n * cols * cols / 64)
+ */
+int gauss_xor(std::vector<std::vector<uint64_t>>& a, int cols) {
+    int n = a.size(), rank = 0;
+    for (int col = 0; col < cols && rank < n; ++col) {
+        int w = col / 64, bit = col % 64, piv = -1;
+        for (int i = rank; i < n && piv == -1; ++i)
+            if (a[i][w] >> bit & 1) piv = i;
+        if (piv == -1) continue;
+        std::swap(a[piv], a[rank]);
+        const std::vector<uint64_t>& p = a[rank];
+        for (int i = 0; i < n; ++i) {
+            if (i == rank || !(a[i][w] >> bit & 1)) continue;
+            for (int k = w; k < static_cast<int>(p.size()); ++k) a[i][k] ^= p[k];
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+#endif /* MATRIX */
@@ -1,10 +1,674 @@
 #ifndef MODULAR
 #define MODULAR
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
+// Computes x^e mod m
+constexpr uint32_t pow_mod(uint64_t x, uint64_t e, uint32_t m) {
+    uint64_t res = 1 % m;
+    for (x %= m; e > 0; e >>= 1, x = x * x % m)
+        if (e & 1) res = res * x % m;
+    return res;
+}
+
+/*
+ * Smallest primitive root modulo prime p < 2^31
+ * g is a primitive root iff g^((p - 1) / q) != 1 for every prime q dividing p - 1
+ * Complexity: O(sqrt(p))
+ */
+constexpr int find_primitive_root(int p) {
+    if (p == 2) return 1;
+    int primes[32] = {}, cnt = 0, x = p - 1;
+    for (int d = 2; d <= x / d; ++d) {
+        if (x % d) continue;
+        primes[cnt++] = d;
+        while (x % d == 0) x /= d;
+    }
+    if (x > 1) primes[cnt++] = x;
+    for (int g = 2;; ++g) {
+        bool ok = true;
+        for (int i = 0; i < cnt && ok; ++i) ok = pow_mod(g, (p - 1) / primes[i], p) != 1;
+        if (ok) return g;
+    }
+}
+
+/*
+ * Modular integer class
+ * MOD must be prime to use inverse and division
+ * 2 * (MOD - 1) <= INT_MAX must hold
+ */
+template <int mod>
+struct modular_int_t {
+    static_assert(mod - 2 <= std::numeric_limits<int>::max() - mod, "2 * (mod - 1) <= INT_MAX");
+    using mint = modular_int_t<mod>;
+
+    int value;
+
+    constexpr modular_int_t() : value(0) {}
+    constexpr modular_int_t(const mint& other) : value(other.value) {}
+
+    template <class T>
+    constexpr modular_int_t(T x) : value(normalize(x)) {}
+
+    template <class T>
+    static constexpr int normalize(T x) {
+        static_assert(std::is_integral<T>::value);
+        if (x < -mod || x > 2 * mod - 1) x %= mod;
+        if (x >= mod) x -= mod;
+        if (x < 0) x += mod;
+        return x;
+    }
+
+    template <class T>
+    constexpr mint power(T deg) const {
+        static_assert(std::is_integral<T>::value);
+        mint res(1), x = *this;
+        while (deg > 0) {
+            if (deg & 1) res *= x;
+            x *= x;
+            deg >>= 1;
+        }
+        return res;
+    }
+
+    constexpr mint inverse() const { return power(mod - 2); }
+
+    static constexpr int get_mod() { return mod; }
+
+    constexpr int val() const { return value; }
+
+    // Lazy reduction: sum of up to LAZY_CNT products of raw() fits into uint64_t
+    static constexpr int LAZY_CNT = 16;
+
+    constexpr uint32_t raw() const { return value; }
+
+    // Converts sum of products of raw() back to mint
+    static constexpr mint from_lazy(uint64_t sum) { return mint(static_cast<int>(sum % mod)); }
+
+    constexpr mint& operator=(const mint& other) {
+        value = other.value;
+        return *this;
+    }
+
+    constexpr mint& operator+=(const mint& other) {
+        if ((value += other.value) >= mod) value -= mod;
+        return *this;
+    }
+
+    constexpr mint& operator-=(const mint& other) {
+        if ((value -= other.value) < 0) value += mod;
+        return *this;
+    }
+
+    constexpr mint& operator*=(const mint& other) {
+        value = (int64_t(value) * other.value) % mod;
+        return *this;
+    }
+
+    constexpr mint& operator/=(const mint& other) { return *this *= other.inverse(); }
+
+    friend constexpr mint operator+(const mint& lhs, const mint& rhs) { return (mint(lhs) += rhs); }
+
+    friend constexpr mint operator-(const mint& lhs, const mint& rhs) { return (mint(lhs) -= rhs); }
+
+    friend constexpr mint operator*(const mint& lhs, const mint& rhs) { return (mint(lhs) *= rhs); }
+
+    friend constexpr mint operator/(const mint& lhs, const mint& rhs) { return (mint(lhs) /= rhs); }
+
+    constexpr mint operator-() const { return mint(-value); }
+
+    friend constexpr bool operator==(const mint& lhs, const mint& rhs) { return lhs.value == rhs.value; }
+
+    friend constexpr bool operator!=(const mint& lhs, const mint& rhs) { return lhs.value != rhs.value; }
+
+    friend constexpr bool operator<(const mint& lhs, const mint& rhs) { return lhs.value < rhs.value; }
+
+    friend constexpr bool operator>(const mint& lhs, const mint& rhs) { return lhs.value > rhs.value; }
+
+    mint& operator++() {
+        ++value;
+        if (value == mod) value = 0;
+        return *this;
+    }
+
+    mint& operator--() {
+        --value;
+        if (value == -1) value = mod - 1;
+        return *this;
+    }
+
+    mint operator++(int) {
+        mint prev = *this;
+        value++;
+        if (value == mod) value = 0;
+        return prev;
+    }
+
+    mint operator--(int) {
+        mint prev = *this;
+        value--;
+        if (value == -1) value = mod - 1;
+        return prev;
+    }
+
+    friend std::istream& operator>>(std::istream& in, mint& num) {
+        int64_t val;
+        in >> val;
+        num.value = normalize(val);
+        return in;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const mint& num) {
+        out << num.value;
+        return out;
+    }
+
+    static int primitive_root() {
+        static const int root = find_primitive_root(mod);
+        return root;
+    }
+};
+
+/*
+ * Modular integer class in Montgomery form, value * 2^32 mod MOD is stored
+ * MOD must be odd and less than 2^30, MOD must be prime to use inverse and division
+ * Multiplication needs neither division nor branches
+ */
+template <int mod>
+struct montgomery_int_t {
+    static_assert(mod % 2 == 1 && mod < (1 << 30), "mod is odd and less than 2^30");
+    using mint = montgomery_int_t<mod>;
+
+    // -mod^{-1} mod 2^32, every Newton iteration doubles the number of correct bits
+    static constexpr uint32_t neg_inv() {
+        uint32_t inv = mod;
+        for (int i = 0; i < 4; ++i) inv *= 2 - mod * inv;
+        return -inv;
+    }
+
+    static constexpr uint32_t N_INV = neg_inv();
+    // 2^64 mod mod
+    static constexpr uint32_t R2 = -static_cast<uint64_t>(mod) % mod;
+
+    uint32_t mont;
+
+    // x * 2^{-32} mod mod for x < mod * 2^32
+    static constexpr uint32_t reduce(uint64_t x) {
+        uint32_t res = (x + static_cast<uint64_t>(static_cast<uint32_t>(x) * N_INV) * mod) >> 32;
+        return res >= mod ? res - mod : res;
+    }
+
+    static constexpr mint from_mont(uint32_t x) {
+        mint res;
+        res.mont = x;
+        return res;
+    }
+
+    constexpr montgomery_int_t() : mont(0) {}
+    constexpr montgomery_int_t(const mint& other) : mont(other.mont) {}
+
+    template <class T>
+    constexpr montgomery_int_t(T x) : mont(reduce(static_cast<uint64_t>(normalize(x)) * R2)) {}
+
+    template <class T>
+    static constexpr int normalize(T x) {
+        static_assert(std::is_integral<T>::value);
+        if (x < -mod || x > 2 * mod - 1) x %= mod;
+        if (x >= mod) x -= mod;
+        if (x < 0) x += mod;
+        return x;
+    }
+
+    template <class T>
+    constexpr mint power(T deg) const {
+        static_assert(std::is_integral<T>::value);
+        mint res(1), x = *this;
+        while (deg > 0) {
+            if (deg & 1) res *= x;
+            x *= x;
+            deg >>= 1;
+        }
+        return res;
+    }
+
+    constexpr mint inverse() const { return power(mod - 2); }
+
+    static constexpr int get_mod() { return mod; }
+
+    constexpr int val() const { return reduce(mont); }
+
+    // Lazy reduction: sum of up to LAZY_CNT products of raw() fits into uint64_t
+    static constexpr int LAZY_CNT = 16;
+
+    constexpr uint32_t raw() const { return mont; }
+
+    // Converts sum of products of raw() back to mint, (a * 2^32) * (b * 2^32) is reduced once
+    static constexpr mint from_lazy(uint64_t sum) { return from_mont(reduce(sum % mod)); }
+
+    constexpr mint& operator=(const mint& other) {
+        mont = other.mont;
+        return *this;
+    }
+
+    constexpr mint& operator+=(const mint& other) {
+        mont += other.mont;
+        mont = mont >= mod ? mont - mod : mont;
+        return *this;
+    }
+
+    constexpr mint& operator-=(const mint& other) {
+        mont = mont >= other.mont ? mont - other.mont : mont + mod - other.mont;
+        return *this;
+    }
+
+    constexpr mint& operator*=(const mint& other) {
+        mont = reduce(static_cast<uint64_t>(mont) * other.mont);
+        return *this;
+    }
+
+    constexpr mint& operator/=(const mint& other) { return *this *= other.inverse(); }
+
+    friend constexpr mint operator+(const mint& lhs, const mint& rhs) { return (mint(lhs) += rhs); }
+
+    friend constexpr mint operator-(const mint& lhs, const mint& rhs) { return (mint(lhs) -= rhs); }
+
+    friend constexpr mint operator*(const mint& lhs, const mint& rhs) { return (mint(lhs) *= rhs); }
+
+    friend constexpr mint operator/(const mint& lhs, const mint& rhs) { return (mint(lhs) /= rhs); }
+
+    constexpr mint operator-() const { return mint() - *this; }
+
+    friend constexpr bool operator==(const mint& lhs, const mint& rhs) { return lhs.mont == rhs.mont; }
+
+    friend constexpr bool operator!=(const mint& lhs, const mint& rhs) { return lhs.mont != rhs.mont; }
+
+    friend constexpr bool operator<(const mint& lhs, const mint& rhs) { return lhs.val() < rhs.val(); }
+
+    friend constexpr bool operator>(const mint& lhs, const mint& rhs) { return lhs.val() > rhs.val(); }
+
+    constexpr mint& operator++() { return *this += 1; }
+
+    constexpr mint& operator--() { return *this -= 1; }
+
+    constexpr mint operator++(int) {
+        mint prev = *this;
+        *this += 1;
+        return prev;
+    }
+
+    constexpr mint operator--(int) {
+        mint prev = *this;
+        *this -= 1;
+        return prev;
+    }
+
+    friend std::istream& operator>>(std::istream& in, mint& num) {
+        int64_t val;
+        in >> val;
+        num = mint(val);
+        return in;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const mint& num) {
+        out << num.val();
+        return out;
+    }
+
+    static int primitive_root() { return modular_int_t<mod>::primitive_root(); }
+};
+
+/*
+ * Modular integer class for prime p = 2^64 - 2^32 + 1
+ * 2^32 divides p - 1, so ntt of length up to 2^32 is possible
+ * Product is computed in __int128 and reduced using 2^64 = 2^32 - 1 and 2^96 = -1 mod p
+ */
+struct goldilocks_int_t {
+    using mint = goldilocks_int_t;
+    static constexpr uint64_t mod = 0xffffffff00000001;
+
+    uint64_t value;
+
+    goldilocks_int_t() : value(0) {}
+    goldilocks_int_t(const mint& other) : value(other.value) {}
+
+    template <class T>
+    goldilocks_int_t(T x) : value(normalize(x)) {}
+
+    template <class T>
+    static uint64_t normalize(T x) {
+        static_assert(std::is_integral<T>::value);
+        __int128 res = static_cast<__int128>(x) % static_cast<__int128>(mod);
+        if (res < 0) res += mod;
+        return res;
+    }
+
+    static uint64_t reduce(unsigned __int128 x) {
+        uint64_t lo = x, hi = x >> 64, hi_hi = hi >> 32, hi_lo = hi & 0xffffffff;
+        // x = lo + hi_lo * 2^64 + hi_hi * 2^96 = lo + hi_lo * (2^32 - 1) - hi_hi
+        // Masks instead of branches, carries are unpredictable
+        uint64_t res, add = (hi_lo << 32) - hi_lo;
+        bool borrow = __builtin_sub_overflow(lo, hi_hi, &res);
+        res -= 0xffffffff & -uint64_t(borrow);
+        bool carry = __builtin_add_overflow(res, add, &res);
+        res += 0xffffffff & -uint64_t(carry);
+        return res - (mod & -uint64_t(res >= mod));
+    }
+
+    template <class T>
+    mint power(T deg) const {
+        static_assert(std::is_integral<T>::value);
+        mint res(1), x = *this;
+        while (deg > 0) {
+            if (deg & 1) res *= x;
+            x *= x;
+            deg >>= 1;
+        }
+        return res;
+    }
+
+    mint inverse() const { return power(mod - 2); }
+
+    static constexpr uint64_t get_mod() { return mod; }
+
+    mint& operator=(const mint& other) {
+        value = other.value;
+        return *this;
+    }
+
+    mint& operator+=(const mint& other) {
+        uint64_t res;
+        // Overflow means res + 2^64 - mod = res + 2^32 - 1
+        bool carry = __builtin_add_overflow(value, other.value, &res);
+        res += 0xffffffff & -uint64_t(carry);
+        value = res - (mod & -uint64_t(res >= mod));
+        return *this;
+    }
+
+    mint& operator-=(const mint& other) {
+        uint64_t res;
+        bool borrow = __builtin_sub_overflow(value, other.value, &res);
+        res -= 0xffffffff & -uint64_t(borrow);
+        value = res;
+        return *this;
+    }
+
+    mint& operator*=(const mint& other) {
+        value = reduce(static_cast<unsigned __int128>(value) * other.value);
+        return *this;
+    }
+
+    mint& operator/=(const mint& other) { return *this *= other.inverse(); }
+
+    friend mint operator+(const mint& lhs, const mint& rhs) { return (mint(lhs) += rhs); }
+
+    friend mint operator-(const mint& lhs, const mint& rhs) { return (mint(lhs) -= rhs); }
+
+    friend mint operator*(const mint& lhs, const mint& rhs) { return (mint(lhs) *= rhs); }
+
+    friend mint operator/(const mint& lhs, const mint& rhs) { return (mint(lhs) /= rhs); }
+
+    mint operator-() { return mint() - *this; }
+
+    friend bool operator==(const mint& lhs, const mint& rhs) { return lhs.value == rhs.value; }
+
+    friend bool operator!=(const mint& lhs, const mint& rhs) { return lhs.value != rhs.value; }
+
+    friend bool operator<(const mint& lhs, const mint& rhs) { return lhs.value < rhs.value; }
+
+    friend bool operator>(const mint& lhs, const mint& rhs) { return lhs.value > rhs.value; }
+
+    friend std::istream& operator>>(std::istream& in, mint& num) {
+        uint64_t val;
+        in >> val;
+        num.value = normalize(val);
+        return in;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const mint& num) {
+        out << num.value;
+        return out;
+    }
+
+    static int primitive_root() { return 7; }
+};
+
+/*
+ * Barrett reduction for modulus 1 <= m < 2^31 known at runtime
+ * im = ceil(2^64 / m), quotient of z / m is estimated as z * im / 2^64 and is off by at most one
+ */
+struct barrett_t {
+    uint32_t m;
+    uint64_t im;
+
+    constexpr explicit barrett_t(uint32_t m) : m(m), im(static_cast<uint64_t>(-1) / m + 1) {}
+
+    // z mod m for z < m^2
+    uint32_t reduce(uint64_t z) const {
+        uint64_t x = (static_cast<unsigned __int128>(z) * im) >> 64, y = x * m;
+        return z - y + (z < y ? m : 0);
+    }
+};
+
+/*
+ * Modular integer class with modulus set at runtime by set_mod, 1 <= mod <= 2^30
+ * Types with different id have independent moduli, and so do different threads: set_mod
+ * affects only the calling thread
+ * Multiplication uses Barrett reduction, inverse uses extended Euclidean algorithm
+ */
+template <int id>
+struct dynamic_modular_int_t {
+    using mint = dynamic_modular_int_t<id>;
+
+    // Every thread has its own modulus, new threads start with 998244353
+    static inline thread_local barrett_t bt = barrett_t(998244353);
+
+    uint32_t value;
+
+    static void set_mod(int m) {
+        assert(1 <= m && m <= (1 << 30));
+        bt = barrett_t(m);
+    }
+
+    static int get_mod() { return bt.m; }
+
+    dynamic_modular_int_t() : value(0) {}
+    dynamic_modular_int_t(const mint& other) : value(other.value) {}
+
+    template <class T>
+    dynamic_modular_int_t(T x) : value(normalize(x)) {}
+
+    template <class T>
+    static uint32_t normalize(T x) {
+        static_assert(std::is_integral<T>::value);
+        if constexpr (std::is_signed<T>::value) {
+            int64_t res = static_cast<int64_t>(x) % get_mod();
+            return res < 0 ? res + get_mod() : res;
+        } else {
+            return static_cast<uint64_t>(x) % get_mod();
+        }
+    }
+
+    template <class T>
+    mint power(T deg) const {
+        static_assert(std::is_integral<T>::value);
+        mint res(1), x = *this;
+        while (deg > 0) {
+            if (deg & 1) res *= x;
+            x *= x;
+            deg >>= 1;
+        }
+        return res;
+    }
+
+    // Works for any modulus if gcd(value, mod) = 1
+    mint inverse() const {
+        int64_t a = value, b = get_mod(), x = 1, y = 0;
+        while (b) {
+            int64_t q = a / b;
+            a -= q * b, x -= q * y;
+            std::swap(a, b), std::swap(x, y);
+        }
+        assert(a == 1);
+        return mint(x);
+    }
+
+    int val() const { return value; }
+
+    // Lazy reduction: sum of up to LAZY_CNT products of raw() fits into uint64_t
+    static constexpr int LAZY_CNT = 16;
+
+    uint32_t raw() const { return value; }
+
+    // Converts sum of products of raw() back to mint
+    static mint from_lazy(uint64_t sum) { return mint(sum); }
+
+    mint& operator=(const mint& other) {
+        value = other.value;
+        return *this;
+    }
+
+    mint& operator+=(const mint& other) {
+        value += other.value;
+        if (value >= bt.m) value -= bt.m;
+        return *this;
+    }
+
+    mint& operator-=(const mint& other) {
+        value = value >= other.value ? value - other.value : value + bt.m - other.value;
+        return *this;
+    }
+
+    mint& operator*=(const mint& other) {
+        value = bt.reduce(static_cast<uint64_t>(value) * other.value);
+        return *this;
+    }
+
+    mint& operator/=(const mint& other) { return *this *= other.inverse(); }
+
+    friend mint operator+(const mint& lhs, const mint& rhs) { return (mint(lhs) += rhs); }
+
+    friend mint operator-(const mint& lhs, const mint& rhs) { return (mint(lhs) -= rhs); }
+
+    friend mint operator*(const mint& lhs, const mint& rhs) { return (mint(lhs) *= rhs); }
+
+    friend mint operator/(const mint& lhs, const mint& rhs) { return (mint(lhs) /= rhs); }
+
+    mint operator-() const { return mint() - *this; }
+
+    friend bool operator==(const mint& lhs, const mint& rhs) { return lhs.value == rhs.value; }
+
+    friend bool operator!=(const mint& lhs, const mint& rhs) { return lhs.value != rhs.value; }
+
+    friend bool operator<(const mint& lhs, const mint& rhs) { return lhs.value < rhs.value; }
+
+    friend bool operator>(const mint& lhs, const mint& rhs) { return lhs.value > rhs.value; }
+
+    mint& operator++() { return *this += 1; }
+
+    mint& operator--() { return *this -= 1; }
+
+    mint operator++(int) {
+        mint prev = *this;
+        *this += 1;
+        return prev;
+    }
+
+    mint operator--(int) {
+        mint prev = *this;
+        *this -= 1;
+        return prev;
+    }
+
+    friend std::istream& operator>>(std::istream& in, mint& num) {
+        int64_t val;
+        in >> val;
+        num = mint(val);
+        return in;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const mint& num) {
+        out << num.value;
+        return out;
+    }
+
+    // Modulus must be prime, the root is cached per thread until the modulus changes
+    static int primitive_root() {
+        thread_local int root_mod = 0, root = 0;
+        if (root_mod != get_mod()) root = find_primitive_root(get_mod()), root_mod = get_mod();
+        return root;
+    }
+};
+
+/*
+ * Computes a[0] * b[0] + a[1] * b[1] + ... + a[n - 1] * b[n - 1]
+ */
+template <class mint>
+mint dot_product(const mint* a, const mint* b, int n) {
+    mint res = 0;
+    for (int i = 0; i < n; ++i) res += a[i] * b[i];
+    return res;
+}
+
+/*
+ * Computes a[0] * b[0] + a[1] * b[1] + ... + a[n - 1] * b[n - 1]
+ * Products of raw values are accumulated in uint64_t and reduced once per LAZY_CNT terms,
+ * LAZY_CNT * (mod - 1)^2 + mod < 2^64 holds for mod <= 2^30
+ */
+template <class mint>
+mint dot_product_lazy(const mint* a, const mint* b, int n) {
+    uint64_t acc = 0;
+    for (int i = 0; i < n; i += mint::LAZY_CNT) {
+        int r = std::min(n, i + mint::LAZY_CNT);
+        for (int j = i; j < r; ++j) acc += static_cast<uint64_t>(a[j].raw()) * b[j].raw();
+        acc %= mint::get_mod();
+    }
+    return mint::from_lazy(acc);
+}
+
+template <int mod>
+modular_int_t<mod> dot_product(const modular_int_t<mod>* a, const modular_int_t<mod>* b, int n) {
+    return dot_product_lazy(a, b, n);
+}
+
+template <int mod>
+montgomery_int_t<mod> dot_product(const montgomery_int_t<mod>* a, const montgomery_int_t<mod>* b,
+                                  int n) {
+    return dot_product_lazy(a, b, n);
+}
+
+template <int id>
+dynamic_modular_int_t<id> dot_product(const dynamic_modular_int_t<id>* a,
+                                      const dynamic_modular_int_t<id>* b, int n) {
+    return dot_product_lazy(a, b, n);
+}
+
+// const int MOD = 1e9 + 7;
+const int MOD = 998244353;
+using mint = montgomery_int_t<MOD>;
+using vm = std::vector<mint>;
+
+using mint64 = goldilocks_int_t;
+using vm64 = std::vector<mint64>;
+
+// Runtime modulus, call dmint::set_mod before use
+using dmint = dynamic_modular_int_t<0>;
+
+/*
+ * Modular integer class for 64-bit modulus
+ * MOD must be prime to use inverse, 2 * (MOD - 1) <= INT64_MAX must hold
+ * Products are computed in __int128
+ */
 template <int64_t mod>
 struct modular_t {
+    static_assert(mod - 2 <= std::numeric_limits<int64_t>::max() - mod,
+                  "2 * (mod - 1) <= INT64_MAX");
+
     int64_t value;
 
     modular_t() : value() {}
@@ -42,7 +706,7 @@ struct modular_t {
     }
 
     modular_t& operator*=(const modular_t& other) {
-        value = normalize(value * other.value);
+        value = static_cast<__int128>(value) * other.value % mod;
         return *this;
     }
 
@@ -118,20 +782,67 @@ struct modular_t {
 
     template <class T>
     friend modular_t power(modular_t a, T deg) {
-        int64_t x = a.value;
-        int64_t y = deg;
-        int64_t z = 1;
-        while (y) {
-            if (y & 1) {
-                z = (z * x) % mod;
-            }
-            x = (x * x) % mod;
-            y = y >> 1;
+        modular_t res = 1;
+        while (deg > 0) {
+            if (deg & 1) res *= a;
+            a *= a;
+            deg >>= 1;
         }
-        return modular_t(z);
+        return res;
     }
 
     modular_t inverse() { return power(*this, mod - 2); }
 };
 
+/*
+ * Montgomery multiplication modulo odd n < 2^62 known at runtime
+ * Numbers are kept in form x * 2^64 mod n, reduction needs two multiplications and a shift
+ * Faster than __int128 % n, which is a library call
+ */
+struct montgomery64_t {
+    uint64_t n, n_inv, r2;
+
+    // n_inv = n^{-1} mod 2^64, r2 = 2^128 mod n
+    explicit montgomery64_t(uint64_t n) : n(n), n_inv(n), r2(-static_cast<unsigned __int128>(n) % n) {
+        assert(n % 2 == 1 && n < (1ULL << 62));
+        for (int i = 0; i < 5; ++i) n_inv *= 2 - n * n_inv;
+    }
+
+    /*
+     * Value in (0, 2n) congruent to x * 2^{-64} mod n for x < n * 2^64
+     * x - m * n is divisible by 2^64 for m = x * n_inv mod 2^64, so only high halves are subtracted
+     */
+    uint64_t reduce_lazy(unsigned __int128 x) const {
+        uint64_t m = static_cast<uint64_t>(x) * n_inv;
+        return static_cast<uint64_t>(x >> 64) + n -
+               static_cast<uint64_t>((static_cast<unsigned __int128>(m) * n) >> 64);
+    }
+
+    // x * 2^{-64} mod n for x < n * 2^64
+    uint64_t reduce(unsigned __int128 x) const {
+        uint64_t res = reduce_lazy(x);
+        return res >= n ? res - n : res;
+    }
+
+    uint64_t to(uint64_t x) const { return reduce(static_cast<unsigned __int128>(x % n) * r2); }
+
+    uint64_t from(uint64_t x) const { return reduce(x); }
+
+    uint64_t mul(uint64_t x, uint64_t y) const {
+        return reduce(static_cast<unsigned __int128>(x) * y);
+    }
+
+    uint64_t add(uint64_t x, uint64_t y) const { return x + y >= n ? x + y - n : x + y; }
+
+    uint64_t sub(uint64_t x, uint64_t y) const { return x >= y ? x - y : x + n - y; }
+
+    // Both x and result are in Montgomery form
+    uint64_t power(uint64_t x, uint64_t deg) const {
+        uint64_t res = to(1);
+        for (; deg > 0; deg >>= 1, x = mul(x, x))
+            if (deg & 1) res = mul(res, x);
+        return res;
+    }
+};
+
 #endif /* MODULAR */
@@ -3,189 +3,111 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
+#include "modular.hpp"
+
 /*
- * Modular integer class
- * MOD must be prime to use inverse and division
- * 2 * (MOD - 1) <= INT_MAX must hold
+ * Roots of unity for ntt over mint, roots[k + i] = w^i, where w is a root of unity of degree 2k,
+ * 0 <= i < k. A published table is never modified, so it can be read from any thread
  */
-template <int mod>
-struct modular_int_t {
-    static_assert(mod - 2 <= std::numeric_limits<int>::max() - mod, "2 * (mod - 1) <= INT_MAX");
-    using mint = modular_int_t<mod>;
+template <class mint>
+struct ntt_roots_t {
+    uint64_t mod = 0;
+    std::vector<mint> roots;
+};
 
-    int value;
+// Latest table, readers only do an acquire load
+template <class mint>
+std::atomic<const ntt_roots_t<mint>*> ntt_roots_current{nullptr};
 
-    modular_int_t() : value(0) {}
-    modular_int_t(const mint& other) : value(other.value) {}
+template <class mint>
+std::mutex ntt_roots_mutex;
 
-    template <class T>
-    modular_int_t(T x) : value(normalize(x)) {}
+/*
+ * Every published table is kept alive, references returned earlier stay valid
+ * Tables of one modulus grow at least twice, and a modulus that comes back reuses its table,
+ * so the memory is at most about twice the largest table of every modulus
+ */
+template <class mint>
+std::vector<std::unique_ptr<const ntt_roots_t<mint>>> ntt_roots_history;
 
-    template <class T>
-    static int normalize(T x) {
-        static_assert(std::is_integral<T>::value);
-        if (x < -mod || x > 2 * mod - 1) x %= mod;
-        if (x >= mod) x -= mod;
-        if (x < 0) x += mod;
-        return x;
-    }
+// Largest table of every modulus seen, guarded by ntt_roots_mutex
+template <class mint>
+std::map<uint64_t, const ntt_roots_t<mint>*> ntt_roots_by_mod;
 
-    template <class T>
-    mint power(T deg) const {
-        static_assert(std::is_integral<T>::value);
-        mint res(1), x = *this;
-        while (deg > 0) {
-            if (deg & 1) res *= x;
-            x *= x;
-            deg >>= 1;
+/*
+ * Roots suitable for ntt of length n, the table is grown under a lock only when it is too short
+ * or computed for another modulus (possible only for runtime modulus)
+ */
+template <class mint>
+const std::vector<mint>& ntt_roots(int n) {
+    const uint64_t mod = mint::get_mod();
+    const ntt_roots_t<mint>* cur = ntt_roots_current<mint>.load(std::memory_order_acquire);
+    if (cur && cur->mod == mod && static_cast<int>(cur->roots.size()) >= n) return cur->roots;
+    std::lock_guard<std::mutex> lock(ntt_roots_mutex<mint>);
+    cur = ntt_roots_current<mint>.load(std::memory_order_relaxed);
+    if (cur && cur->mod == mod && static_cast<int>(cur->roots.size()) >= n) return cur->roots;
+    const ntt_roots_t<mint>*& latest = ntt_roots_by_mod<mint>[mod];
+    if (latest && static_cast<int>(latest->roots.size()) >= n) {
+        ntt_roots_current<mint>.store(latest, std::memory_order_release);
+        return latest->roots;
+    }
+    auto next = std::make_unique<ntt_roots_t<mint>>();
+    next->mod = mod;
+    std::vector<mint>& roots = next->roots;
+    if (latest) roots = latest->roots;
+    else roots = {0, 1};
+    int target = std::max<int>(n, 2 * roots.size());
+    for (int k = roots.size(); k < target; k *= 2) {
+        // Length 2k must divide mod - 1
+        if ((mod - 1) % (2 * k) != 0) break;
+        mint wn = mint(mint::primitive_root()).power((mod - 1) / (2 * k));
+        roots.resize(2 * k);
+        for (int i = k; i < 2 * k; i += 2) {
+            roots[i] = roots[i / 2];
+            roots[i + 1] = roots[i] * wn;
         }
-        return res;
-    }
-
-    mint inverse() const { return power(mod - 2); }
-
-    mint& operator=(const mint& other) {
-        value = other.value;
-        return *this;
-    }
-
-    mint& operator+=(const mint& other) {
-        if ((value += other.value) >= mod) value -= mod;
-        return *this;
-    }
-
-    mint& operator-=(const mint& other) {
-        if ((value -= other.value) < 0) value += mod;
-        return *this;
     }
-
-    mint& operator*=(const mint& other) {
-        value = (int64_t(value) * other.value) % mod;
-        return *this;
-    }
-
-    mint& operator/=(const mint& other) { return *this *= other.inverse(); }
-
-    friend mint operator+(const mint& lhs, const mint& rhs) { return (mint(lhs) += rhs); }
-
-    friend mint operator-(const mint& lhs, const mint& rhs) { return (mint(lhs) -= rhs); }
-
-    friend mint operator*(const mint& lhs, const mint& rhs) { return (mint(lhs) *= rhs); }
-
-    friend mint operator/(const mint& lhs, const mint& rhs) { return (mint(lhs) /= rhs); }
-
-    mint operator-() { return mint(-value); }
-
-    friend bool operator==(const mint& lhs, const mint& rhs) { return lhs.value == rhs.value; }
-
-    friend bool operator!=(const mint& lhs, const mint& rhs) { return lhs.value != rhs.value; }
-
-    friend bool operator<(const mint& lhs, const mint& rhs) { return lhs.value < rhs.value; }
-
-    friend bool operator>(const mint& lhs, const mint& rhs) { return lhs.value > rhs.value; }
-
-    mint& operator++() {
-        ++value;
-        if (value == mod) value = 0;
-        return *this;
-    }
-
-    mint& operator--() {
-        --value;
-        if (value == -1) value = mod - 1;
-        return *this;
-    }
-
-    mint operator++(int) {
-        mint prev = *this;
-        value++;
-        if (value == mod) value = 0;
-        return prev;
-    }
-
-    mint operator--(int) {
-        mint prev = *this;
-        value--;
-        if (value == -1) value = mod - 1;
-        return prev;
-    }
-
-    friend std::istream& operator>>(std::istream& in, mint& num) {
-        int64_t val;
-        in >> val;
-        num.value = normalize(val);
-        return in;
-    }
-
-    friend std::ostream& operator<<(std::ostream& out, const mint& num) {
-        out << num.value;
-        return out;
-    }
-
-    static int primitive_root() {
-        if (mod == 1000000007) return 5;
-        if (mod == 998244353) return 3;
-        if (mod == 786433) return 10;
-
-        static int root = -1;
-        if (root != -1) return root;
-
-        assert(false);
-        // todo calc for any modulo
-    }
-};
-
-// const int MOD = 1e9 + 7;
-const int MOD = 998244353;
-using mint = modular_int_t<MOD>;
-using vm = std::vector<mint>;
-
-constexpr int MAX_K = __builtin_ctz(MOD - 1);
-int rev_bits(int x) {
-    int y = 0;
-    for (int i = 0; i < MAX_K; ++i) {
-        y = y ^ (x & 1);
-        y = y << 1;
-        x = x >> 1;
-    }
-    return (y >> 1);
+    assert(static_cast<int>(roots.size()) >= n);
+    latest = next.get();
+    ntt_roots_current<mint>.store(next.get(), std::memory_order_release);
+    ntt_roots_history<mint>.push_back(std::move(next));
+    return roots;
 }
 
-bool flag_ntt_precalc = false;
-std::array<int, 1 << MAX_K> ntt_rev;
-std::array<mint, 2 * (1 << MAX_K)> ntt_roots;
-void ntt_precalc() {
-    for (int i = 0; i < (1 << MAX_K); ++i) ntt_rev[i] = rev_bits(i);
-    mint g = mint::primitive_root(), w = g.power((MOD - 1) / (1 << MAX_K));
-    for (int cluster = 2; cluster <= (1 << MAX_K); cluster *= 2) {
-        ntt_roots[cluster] = 1;
-        mint wn = w.power((1 << MAX_K) / cluster);
-        for (int i = 1; i < cluster / 2; ++i)
-            ntt_roots[cluster + i] = ntt_roots[cluster + i - 1] * wn;
-    }
-    flag_ntt_precalc = 1;
+// Makes ntt of length up to n lock-free, call it once before starting worker threads
+template <class mint>
+void ntt_precalc(int n) {
+    ntt_roots<mint>(n);
 }
 
-void ntt(vm& a, bool inverse = false) {
-    if (!flag_ntt_precalc) ntt_precalc();
+template <class mint>
+void ntt(std::vector<mint>& a, bool inverse = false) {
+    int n = a.size();
+    const std::vector<mint>& roots = ntt_roots<mint>(n);
     // Look at the Wandermond matrix: you don't need inverse of wn!
     if (inverse) std::reverse(a.begin() + 1, a.end());
-    // Count tailing zeros
-    int n = a.size(), lg_n = __builtin_ctz(n);
-    for (int i = 0; i < n; ++i) {
-        int rev_i = ntt_rev[i] >> (MAX_K - lg_n);
-        if (i < rev_i) std::swap(a[i], a[rev_i]);
+    // Bit reversal permutation, j is reversed i
+    for (int i = 1, j = 0; i < n; ++i) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
     }
     for (int cluster = 2; cluster <= n; cluster *= 2) {
         for (int j = 0; j < n; j += cluster) {
             for (int k = 0; k < cluster / 2; ++k) {
                 mint u = a[j + k];
-                mint v = a[j + k + cluster / 2] * ntt_roots[cluster + k];
+                mint v = a[j + k + cluster / 2] * roots[cluster / 2 + k];
                 a[j + k] = u + v;
                 a[j + k + cluster / 2] = u - v;
             }
@@ -197,13 +119,16 @@ void ntt(vm& a, bool inverse = false) {
     }
 }
 
-struct polynom {
+template <class mint>
+struct polynom_t {
+    using vm = std::vector<mint>;
+
     vm data;
 
-    polynom() : data(1) {}
-    polynom(int n) : data(n) {}
-    polynom(int n, const mint& el) : data(n, el) {}
-    polynom(const vm& coef) : data(coef) {}
+    polynom_t() : data(1) {}
+    polynom_t(int n) : data(n) {}
+    polynom_t(int n, const mint& el) : data(n, el) {}
+    polynom_t(const vm& coef) : data(coef) {}
 
     int size() const { return data.size(); }
     void resize(int n) { data.resize(n); }
@@ -211,45 +136,45 @@ struct polynom {
     mint& operator[](int id) { return data[id]; }
     const mint& operator[](int id) const { return data[id]; }
 
-    polynom& operator+=(const polynom& rhs) {
+    polynom_t& operator+=(const polynom_t& rhs) {
         if (rhs.size() > size()) resize(rhs.size());
         for (int i = 0; i < rhs.size(); ++i) data[i] += rhs[i];
         return *this;
     }
 
-    polynom& operator-=(const polynom& rhs) {
+    polynom_t& operator-=(const polynom_t& rhs) {
         if (rhs.size() > size()) resize(rhs.size());
         for (int i = 0; i < rhs.size(); ++i) data[i] -= rhs[i];
         return *this;
     }
 
-    polynom& operator*=(mint lambda) {
+    polynom_t& operator*=(mint lambda) {
         for (int i = 0; i < size(); ++i) data[i] *= lambda;
         return *this;
     }
 
-    polynom& operator/=(mint lambda) { return *this *= lambda.inverse(); }
+    polynom_t& operator/=(mint lambda) { return *this *= lambda.inverse(); }
 
-    friend polynom operator+(const polynom& lhs, const polynom& rhs) {
-        return (polynom(lhs) += rhs);
+    friend polynom_t operator+(const polynom_t& lhs, const polynom_t& rhs) {
+        return (polynom_t(lhs) += rhs);
     }
 
-    friend polynom operator-(const polynom& lhs, const polynom& rhs) {
-        return (polynom(lhs) -= rhs);
+    friend polynom_t operator-(const polynom_t& lhs, const polynom_t& rhs) {
+        return (polynom_t(lhs) -= rhs);
     }
 
-    friend polynom operator*(mint lambda, const polynom& p) { return (polynom(p) *= lambda); }
+    friend polynom_t operator*(mint lambda, const polynom_t& p) { return (polynom_t(p) *= lambda); }
 
-    friend polynom operator/(const polynom& p, mint lambda) { return (polynom(p) /= lambda); }
+    friend polynom_t operator/(const polynom_t& p, mint lambda) { return (polynom_t(p) /= lambda); }
 
-    friend polynom multiply_naive(const polynom& lhs, const polynom& rhs) {
-        polynom res(lhs.size() + rhs.size() - 1);
+    friend polynom_t multiply_naive(const polynom_t& lhs, const polynom_t& rhs) {
+        polynom_t res(lhs.size() + rhs.size() - 1);
         for (int i = 0; i < lhs.size(); ++i)
             for (int j = 0; j < rhs.size(); ++j) res[i + j] += lhs[i] * rhs[j];
         return res;
     }
 
-    friend polynom multiply_ntt(const polynom& lhs, const polynom& rhs) {
+    friend polynom_t multiply_ntt(const polynom_t& lhs, const polynom_t& rhs) {
         int out_sz = lhs.size() + rhs.size() - 1, lg_sz = 32 - __builtin_clz(out_sz),
             n = 1 << lg_sz;
         vm a(lhs.data), b(rhs.data);
@@ -265,14 +190,50 @@ struct polynom {
     // Optimize multiplication by low degree polynom
     constexpr static int FFT_NAIVE_SZ_ = 60;
 
-    friend polynom operator*(const polynom& lhs, const polynom& rhs) {
+    friend polynom_t operator*(const polynom_t& lhs, const polynom_t& rhs) {
         if (std::min(lhs.size(), rhs.size()) < FFT_NAIVE_SZ_)
             return multiply_naive(lhs, rhs);
         else
             return multiply_ntt(lhs, rhs);
     }
 
-    friend std::istream& operator>>(std::istream& in, polynom& poly) {
+    // Optimize inverse, log, exp and modpow of polynom with few nonzero terms
+    constexpr static int SPARSE_SZ_ = 50;
+
+    // Sparse representation: (index, value) pairs of nonzero terms sorted by index
+    using sparse_t = std::vector<std::pair<int, mint>>;
+
+    // Nonzero terms of polynom, stops after limit + 1 terms are found
+    sparse_t sparse(int limit = std::numeric_limits<int>::max()) const {
+        sparse_t res;
+        for (int i = 0; i < size() && static_cast<int>(res.size()) <= limit; ++i)
+            if (data[i] != 0) res.emplace_back(i, data[i]);
+        return res;
+    }
+
+    // Inverses of 0, 1, ..., n - 1 with a single exponentiation, 0 is mapped to 0
+    static vm inverses(int n) {
+        vm res(n), pref(n, 1);
+        if (n < 2) return res;
+        for (int i = 2; i < n; ++i) pref[i] = pref[i - 1] * i;
+        mint cur = pref[n - 1].inverse();
+        for (int i = n - 1; i > 0; --i) {
+            res[i] = cur * pref[i - 1];
+            cur *= i;
+        }
+        return res;
+    }
+
+    // Factorials and inverse factorials of 0, 1, ..., n - 1 with a single exponentiation
+    static void factorials(int n, vm& fact, vm& inv_fact) {
+        fact.assign(n, 1), inv_fact.assign(n, 1);
+        if (n < 2) return;
+        for (int i = 1; i < n; ++i) fact[i] = fact[i - 1] * i;
+        inv_fact[n - 1] = fact[n - 1].inverse();
+        for (int i = n - 1; i > 1; --i) inv_fact[i - 1] = inv_fact[i] * i;
+    }
+
+    friend std::istream& operator>>(std::istream& in, polynom_t& poly) {
         int deg;
         in >> deg;
         int n = deg + 1;
@@ -281,7 +242,7 @@ struct polynom {
         return in;
     }
 
-    friend std::ostream& operator<<(std::ostream& out, const polynom& poly) {
+    friend std::ostream& operator<<(std::ostream& out, const polynom_t& poly) {
         for (int i = 0; i < poly.size(); ++i) {
             if (i) out << ' ';
             out << poly[i];
@@ -294,9 +255,11 @@ struct polynom {
      * Complexity: O(m log m log y)
      */
     template <class T>
-    polynom modpow(T y, int m) const {
+    polynom_t modpow(T y, int m) const {
         static_assert(std::is_integral<T>::value);
-        polynom res(1, 1), p(data);
+        sparse_t sp = sparse(SPARSE_SZ_);
+        if (static_cast<int>(sp.size()) <= SPARSE_SZ_) return modpow_sparse(sp, y, m);
+        polynom_t res(1, 1), p(data);
         while (y > 0) {
             if (y % 2) {
                 res = res * p;
@@ -310,24 +273,58 @@ struct polynom {
         return res;
     }
 
+    /*
+     * Computes f ^ y mod x ^ m for f given by nonzero terms
+     * f(x) = x^t * r(x), r(0) != 0, q(x) = r(x) ^ y satisfies r(x) * q'(x) = y * r'(x) * q(x):
+     * i * r_0 * q_i = sum_{j >= 1} r_j * q_{i - j} * (y * j - (i - j))
+     * Complexity: O(mk), k is the number of nonzero terms
+     */
+    template <class T>
+    static polynom_t modpow_sparse(const sparse_t& f, T y, int m) {
+        static_assert(std::is_integral<T>::value);
+        polynom_t res(m);
+        if (y == 0) {
+            if (m > 0) res[0] = 1;
+            return res;
+        }
+        if (f.empty()) return res;
+        int t = f[0].first;
+        if (t > 0 && y >= (m + t - 1) / t) return res;
+        int s = t * y, len = m - s;
+        vm inv = inverses(len);
+        mint r0 = f[0].second, inv_r0 = r0.inverse(), y_mod(y);
+        res[s] = r0.power(y);
+        for (int i = 1; i < len; ++i) {
+            mint sum = 0;
+            for (int k = 1; k < static_cast<int>(f.size()) && f[k].first - t <= i; ++k) {
+                int j = f[k].first - t;
+                sum += f[k].second * res[s + i - j] * (y_mod * j - (i - j));
+            }
+            res[s + i] = sum * inv_r0 * inv[i];
+        }
+        return res;
+    }
+
     /*
      * For a given polynomial f(x) computes polynomial g(x)
      * such that f(x) * g(x) = 1 mod x^n
      * Complexity: O(n log n)
      */
-    polynom inverse(int n) {
+    polynom_t inverse(int n) {
+        sparse_t sp = sparse(SPARSE_SZ_);
+        if (static_cast<int>(sp.size()) <= SPARSE_SZ_) return inverse_sparse(sp, n);
         int lg_n = 32 - __builtin_clz(n);
         auto p0 = data[0], q0 = p0.inverse();
-        polynom p(1, -p0), q(1, q0);
+        polynom_t p(1, -p0), q(1, q0);
         p.data.reserve(1 << lg_n);
         // Q_{k+1} = Q_k * (2 - P * Q_k)
         for (int k = 0; k < lg_n; ++k) {
             int nxt_sz = 1 << (k + 1);
             for (int i = nxt_sz / 2; i < std::min(size(), nxt_sz); ++i) p.data.push_back(-data[i]);
-            polynom pq = p * q;
+            polynom_t pq = p * q;
             pq.resize(nxt_sz);
             pq[0] += 2;
-            polynom nq = q * pq;
+            polynom_t nq = q * pq;
             nq.resize(nxt_sz);
             q = nq;
         }
@@ -335,14 +332,33 @@ struct polynom {
         return q;
     }
 
-    polynom deriv() {
-        polynom res(data.size() - 1);
+    /*
+     * Computes g(x) = 1 / f(x) mod x^n for f given by nonzero terms, f(0) != 0
+     * g_i = -1 / f_0 * sum_{j >= 1} f_j * g_{i - j}
+     * Complexity: O(nk), k is the number of nonzero terms
+     */
+    static polynom_t inverse_sparse(const sparse_t& f, int n) {
+        assert(!f.empty() && f[0].first == 0);
+        polynom_t g(n);
+        mint inv_f0 = f[0].second.inverse(), neg_inv_f0 = -inv_f0;
+        if (n > 0) g[0] = inv_f0;
+        for (int i = 1; i < n; ++i) {
+            mint sum = 0;
+            for (int k = 1; k < static_cast<int>(f.size()) && f[k].first <= i; ++k)
+                sum += f[k].second * g[i - f[k].first];
+            g[i] = sum * neg_inv_f0;
+        }
+        return g;
+    }
+
+    polynom_t deriv() {
+        polynom_t res(data.size() - 1);
         for (int i = 1; i < size(); ++i) res[i - 1] = data[i] * i;
         return res;
     }
 
-    polynom integrate() {
-        polynom res(data.size() + 1);
+    polynom_t integrate() {
+        polynom_t res(data.size() + 1);
         for (int i = 0; i < size(); ++i) res[i + 1] = data[i] / (i + 1);
         return res;
     }
@@ -352,25 +368,57 @@ struct polynom {
      * Complexity: O(n log n)
      * Taylor series: ln(1 - x) = -( x + x^2 / 2 + x^3 / 3 + x^4 / 4 + ... )
      */
-    polynom log(int n) { return (deriv() * inverse(n)).integrate(); }
+    polynom_t log(int n) {
+        sparse_t sp = sparse(SPARSE_SZ_);
+        if (static_cast<int>(sp.size()) <= SPARSE_SZ_) return log_sparse(sp, n);
+        polynom_t res = (deriv() * inverse(n)).integrate();
+        res.resize(n);
+        return res;
+    }
+
+    /*
+     * Calculates first n terms of ln f(x) for f given by nonzero terms, f(0) != 0
+     * From f(x) * g'(x) = f'(x), where g(x) = ln f(x):
+     * i * g_i = (i * f_i - sum_{j >= 1} f_j * (i - j) * g_{i - j}) / f_0
+     * Complexity: O(nk), k is the number of nonzero terms
+     */
+    static polynom_t log_sparse(const sparse_t& f, int n) {
+        assert(!f.empty() && f[0].first == 0);
+        polynom_t g(n);
+        // dg[i] = i * g_i
+        vm dg(n), inv = inverses(n);
+        mint inv_f0 = f[0].second.inverse();
+        for (int i = 1; i < n; ++i) {
+            mint sum = 0;
+            int k = 1;
+            for (; k < static_cast<int>(f.size()) && f[k].first < i; ++k)
+                sum -= f[k].second * dg[i - f[k].first];
+            if (k < static_cast<int>(f.size()) && f[k].first == i) sum += f[k].second * i;
+            dg[i] = sum * inv_f0;
+            g[i] = dg[i] * inv[i];
+        }
+        return g;
+    }
 
     /*
      * Calculates first n terms of e^P(x)
      * Complexity: O(n log n)
      * Taylor series: e^x = 1 + x + x^2 / 2! + x^3 / 3! + x^4 / 4! + ...
      */
-    polynom exp(int n) {
+    polynom_t exp(int n) {
+        sparse_t sp = sparse(SPARSE_SZ_);
+        if (static_cast<int>(sp.size()) <= SPARSE_SZ_) return exp_sparse(sp, n);
         int lg_n = 32 - __builtin_clz(n);
         auto p0 = data[0];
-        polynom p(1, p0), q(1, 1);
+        polynom_t p(1, p0), q(1, 1);
         p.data.reserve(1 << lg_n);
         // Q_{k+1} = Q_k * (1 + P - ln Q_k)
         for (int k = 0; k < lg_n; ++k) {
             int nxt_sz = 1 << (k + 1);
             for (int i = nxt_sz / 2; i < std::min(size(), nxt_sz); ++i) p.data.push_back(data[i]);
-            polynom tmp = p - q.log(nxt_sz);
+            polynom_t tmp = p - q.log(nxt_sz);
             tmp[0] += 1;
-            polynom nq = q * tmp;
+            polynom_t nq = q * tmp;
             nq.resize(nxt_sz);
             q = nq;
         }
@@ -378,6 +426,96 @@ struct polynom {
         return q;
     }
 
+    /*
+     * Calculates first n terms of e^f(x) for f given by nonzero terms, f(0) = 0
+     * From g'(x) = f'(x) * g(x), where g(x) = e^f(x):
+     * i * g_i = sum_{j >= 1} j * f_j * g_{i - j}
+     * Complexity: O(nk), k is the number of nonzero terms
+     */
+    static polynom_t exp_sparse(const sparse_t& f, int n) {
+        assert(f.empty() || f[0].first > 0);
+        polynom_t g(n);
+        vm inv = inverses(n);
+        sparse_t df(f);
+        for (auto& [j, fj] : df) fj *= j;
+        if (n > 0) g[0] = 1;
+        for (int i = 1; i < n; ++i) {
+            mint sum = 0;
+            for (int k = 0; k < static_cast<int>(df.size()) && df[k].first <= i; ++k)
+                sum += df[k].second * g[i - df[k].first];
+            g[i] = sum * inv[i];
+        }
+        return g;
+    }
+
+    /*
+     * Computes p(x + c), Taylor shift
+     * [x^k] p(x + c) = 1 / k! * sum_{i >= k} p_i * i! * c^{i - k} / (i - k)!
+     * Reversing p_i * i! turns the sum into a single convolution
+     * Complexity: O(n log n)
+     */
+    polynom_t taylor_shift(mint c) const {
+        int n = size();
+        vm fact, inv_fact;
+        factorials(n, fact, inv_fact);
+        polynom_t a(n), b(n);
+        mint pw = 1;
+        for (int i = 0; i < n; ++i) {
+            a[n - 1 - i] = data[i] * fact[i];
+            b[i] = pw * inv_fact[i];
+            pw *= c;
+        }
+        polynom_t ab = a * b, res(n);
+        for (int k = 0; k < n; ++k) res[k] = ab[n - 1 - k] * inv_fact[k];
+        return res;
+    }
+
+    /*
+     * Given values f(0), f(1), ..., f(n - 1) of polynomial f, deg f < n,
+     * computes values f(m), f(m + 1), ..., f(m + n - 1), 0 <= m and m + n <= MOD
+     * Lagrange interpolation for m >= n:
+     * f(m + k) = prod_{j < n} (m + k - j) * sum_{i < n} a_i / (m + k - i), where
+     * a_i = f(i) * (-1)^{n - 1 - i} / (i! * (n - 1 - i)!)
+     * The sum is a single convolution of a_i and 1 / (m - n + 1 + j)
+     * Complexity: O(n log n)
+     */
+    template <class T>
+    friend polynom_t sample_shift(const polynom_t& f, T m) {
+        static_assert(std::is_integral<T>::value);
+        int n = f.size();
+        if (n == 0) return f;
+        if (m < n) {
+            // Points m + k < n are known, the rest is taken from f(n), ..., f(2n - 1)
+            polynom_t tail = sample_shift(f, n), res(n);
+            for (int k = 0; k < n; ++k) res[k] = m + k < n ? f[m + k] : tail[m + k - n];
+            return res;
+        }
+        vm fact, inv_fact;
+        factorials(n, fact, inv_fact);
+        polynom_t a(n), b(2 * n - 1);
+        for (int i = 0; i < n; ++i) {
+            a[i] = f[i] * inv_fact[i] * inv_fact[n - 1 - i];
+            if ((n - 1 - i) % 2) a[i] = -a[i];
+        }
+        // v_j = m - n + 1 + j, pref[j] = v_0 * v_1 * ... * v_{j - 1}
+        mint v0 = mint(m) - (n - 1);
+        vm pref(2 * n, 1);
+        for (int j = 0; j < 2 * n - 1; ++j) pref[j + 1] = pref[j] * (v0 + j);
+        mint inv_pref = pref[2 * n - 1].inverse();
+        for (int j = 2 * n - 2; j >= 0; --j) {
+            b[j] = inv_pref * pref[j];
+            inv_pref *= v0 + j;
+        }
+        polynom_t ab = a * b, res(n);
+        // prod_{j < n} (m + k - j) = v_k * v_{k + 1} * ... * v_{k + n - 1}
+        mint prod = pref[n];
+        for (int k = 0; k < n; ++k) {
+            res[k] = ab[k + n - 1] * prod;
+            if (k + 1 < n) prod *= (v0 + (k + n)) * b[k];
+        }
+        return res;
+    }
+
     /*
      * Given generating function G(x) in form P(x)/Q(x), where d = deg(Q(x)) and deg(P) <= d - 1
      * Computes n-th term of G(x): a_n = [x^n] P(x)/Q(x)
@@ -389,18 +527,18 @@ struct polynom {
      * F(x) = a_0 + a_1 * x + a_2 * x^2 + ... a_{d-1} * x^{d-1}
      */
     template <class T>
-    friend mint BostanMori(polynom p, polynom q, T n) {
+    friend mint BostanMori(polynom_t p, polynom_t q, T n) {
         static_assert(std::is_integral<T>::value);
         int d = q.size();
         assert(p.size() < d);
         p.resize(d - 1);
         while (n > 0) {
-            polynom q_neg(q);
+            polynom_t q_neg(q);
             for (int i = 1; i < d; i += 2) q_neg[i] *= -1;
             // U(x) = P(x) * Q(-x)
-            polynom u = p * q_neg;
+            polynom_t u = p * q_neg;
             // V(x ^ 2) = Q(x) * Q(-x)
-            polynom vv = q * q_neg;
+            polynom_t vv = q * q_neg;
             // P(x) = U_e(x) or U_o(x)
             for (int i = 0; i < d - 1; ++i) p[i] = u[2 * i + n % 2];
             // Q(x) = V(x)
@@ -412,15 +550,266 @@ struct polynom {
 
     void rev() { std::reverse(data.begin(), data.end()); }
 
-    friend polynom operator/(polynom lhs, polynom rhs) {
-        int n = lhs.size(), m = rhs.size();
-        if (n < m) return polynom(1, 0);
+    // Degree of polynom, -1 for zero polynom
+    int deg() const {
+        int d = size() - 1;
+        while (d >= 0 && data[d] == 0) --d;
+        return d;
+    }
+
+    // Removes leading zero coefficients, zero polynom keeps one coefficient
+    void shrink() { resize(std::max(deg(), 0) + 1); }
+
+    // p(x) div x^k
+    polynom_t div_xk(int k) const {
+        if (k >= size()) return polynom_t(1, 0);
+        return vm(data.begin() + k, data.end());
+    }
+
+    // Quotient of division, leading zeros of rhs are ignored
+    friend polynom_t operator/(const polynom_t& lhs, const polynom_t& rhs) {
+        int n = lhs.size(), m = rhs.deg() + 1;
+        assert(m > 0);
+        if (n < m) return polynom_t(1, 0);
         int out_sz = n - m + 1;
-        lhs.rev(), rhs.rev();
-        polynom res = lhs * rhs.inverse(out_sz);
+        // Only the highest out_sz coefficients of both polynoms matter
+        polynom_t a(vm(lhs.data.rbegin(), lhs.data.rbegin() + out_sz));
+        polynom_t b(vm(rhs.data.rend() - m, rhs.data.rend() - m + std::min(m, out_sz)));
+        polynom_t res = a * b.inverse(out_sz);
         res.resize(out_sz), res.rev();
         return res;
     }
+
+    /*
+     * Quotient and remainder: lhs = q * rhs + r, deg r < deg rhs
+     * One inverse and two multiplications
+     * Complexity: O(n log n)
+     */
+    friend std::pair<polynom_t, polynom_t> divmod(const polynom_t& lhs, const polynom_t& rhs) {
+        int m = rhs.deg() + 1;
+        if (lhs.size() < m) return {polynom_t(1, 0), lhs};
+        polynom_t q = lhs / rhs, r = rhs * q;
+        r.resize(std::max(m - 1, 1));
+        for (int i = 0; i < r.size(); ++i) r[i] = lhs[i] - r[i];
+        return {q, r};
+    }
+
+    friend polynom_t operator%(const polynom_t& lhs, const polynom_t& rhs) { return divmod(lhs, rhs).second; }
+
+    /*
+     * Remainder sequence of Euclidean algorithm r_0, r_1, r_2, ..., r_{i+1} = r_{i-1} mod r_i
+     * Pair (r_i, r_{i+1}) is transformed by 2x2 polynomial matrices
+     * {a, b, c, d} * (p, q) = (a * p + b * q, c * p + d * q)
+     * Degrees and leading coefficients of quotients are stored in quot_list if it is needed
+     */
+    using poly_pair = std::array<polynom_t, 2>;
+    using poly_matrix = std::array<polynom_t, 4>;
+    using quot_list = std::vector<std::pair<int, mint>>;
+
+    static poly_matrix euclid_identity() {
+        return {polynom_t(1, 1), polynom_t(1, 0), polynom_t(1, 0), polynom_t(1, 1)};
+    }
+
+    static poly_pair euclid_apply(const poly_matrix& m, const poly_pair& p) {
+        poly_pair res = {m[0] * p[0] + m[1] * p[1], m[2] * p[0] + m[3] * p[1]};
+        res[0].shrink(), res[1].shrink();
+        return res;
+    }
+
+    static poly_matrix euclid_compose(const poly_matrix& l, const poly_matrix& r) {
+        poly_matrix res = {l[0] * r[0] + l[1] * r[2], l[0] * r[1] + l[1] * r[3],
+                           l[2] * r[0] + l[3] * r[2], l[2] * r[1] + l[3] * r[3]};
+        for (polynom_t& el : res) el.shrink();
+        return res;
+    }
+
+    // Single step (p, q) -> (q, p mod q), returns quotient
+    static polynom_t euclid_step(poly_pair& p, quot_list* quots) {
+        auto [quot, r] = divmod(p[0], p[1]);
+        quot.shrink(), r.shrink();
+        if (quots) quots->emplace_back(quot.deg(), quot[quot.deg()]);
+        p = {p[1], r};
+        return quot;
+    }
+
+    // Single step, m accumulates the transformation
+    static void euclid_step(poly_matrix& m, poly_pair& p, quot_list* quots) {
+        polynom_t quot = euclid_step(p, quots);
+        polynom_t m2 = m[0] - quot * m[2], m3 = m[1] - quot * m[3];
+        m2.shrink(), m3.shrink();
+        m = {m[2], m[3], m2, m3};
+    }
+
+    /*
+     * Half-GCD, deg p[0] > deg p[1] must hold
+     * Returns matrix of Euclidean steps taking (p[0], p[1]) to (r_i, r_{i+1}),
+     * where deg r_i >= k > deg r_{i+1}, k = (deg p[0] + 1) / 2
+     * The steps depend only on the high halves of p[0] and p[1], which gives recursion
+     * Complexity: O(n log^2 n)
+     */
+    static poly_matrix half_gcd(poly_pair p, quot_list* quots = nullptr) {
+        int k = (p[0].deg() + 1) / 2;
+        if (p[1].deg() < k) return euclid_identity();
+        poly_matrix res = half_gcd({p[0].div_xk(k), p[1].div_xk(k)}, quots);
+        p = euclid_apply(res, p);
+        if (p[1].deg() < k) return res;
+        euclid_step(res, p, quots);
+        if (p[1].deg() < k) return res;
+        int j = 2 * k - p[0].deg();
+        return euclid_compose(half_gcd({p[0].div_xk(j), p[1].div_xk(j)}, quots), res);
+    }
+
+    // Runs Euclidean algorithm until p[1] = 0, p[0] becomes gcd
+    static void euclid_run(poly_pair& p, quot_list* quots = nullptr) {
+        p[0].shrink(), p[1].shrink();
+        while (p[1].deg() >= 0) {
+            if (p[0].deg() > p[1].deg()) p = euclid_apply(half_gcd(p, quots), p);
+            if (p[1].deg() < 0) break;
+            euclid_step(p, quots);
+        }
+    }
+
+    /*
+     * Monic greatest common divisor, zero for two zero polynoms
+     * Complexity: O(n log^2 n)
+     */
+    friend polynom_t gcd(const polynom_t& a, const polynom_t& b) {
+        poly_pair p = {a, b};
+        if (a.deg() < b.deg()) std::swap(p[0], p[1]);
+        euclid_run(p);
+        int d = p[0].deg();
+        if (d >= 0) p[0] /= p[0][d];
+        return p[0];
+    }
+
+    /*
+     * Resultant of a and b: lc(a)^{deg b} * prod b(x_i) over roots x_i of a
+     * Computed from quotients of Euclidean algorithm, d_i = deg r_i:
+     * res(r_{i-1}, r_i) = (-1)^{d_{i-1} d_i} * lc(r_i)^{d_{i-1} - d_{i+1}} * res(r_i, r_{i+1})
+     * Degrees and leading coefficients of r_i are restored from the quotients
+     * Complexity: O(n log^2 n)
+     */
+    friend mint resultant(const polynom_t& a, const polynom_t& b) {
+        int da = a.deg(), db = b.deg();
+        if (da < 0 || db < 0) return 0;
+        mint res = 1;
+        poly_pair p = {a, b};
+        if (da < db) {
+            std::swap(p[0], p[1]), std::swap(da, db);
+            if (da % 2 && db % 2) res = -res;
+        }
+        mint lc = p[0][da];
+        quot_list quots;
+        euclid_run(p, &quots);
+        int k = quots.size();
+        std::vector<int> d(k + 1);
+        vm lcs(k + 1);
+        d[0] = da, lcs[0] = lc;
+        for (int i = 1; i <= k; ++i) {
+            d[i] = d[i - 1] - quots[i - 1].first;
+            lcs[i] = lcs[i - 1] / quots[i - 1].second;
+        }
+        if (d[k] > 0) return 0;
+        for (int i = 1; i < k; ++i) {
+            if (d[i - 1] % 2 && d[i] % 2) res = -res;
+            res *= lcs[i].power(d[i - 1] - d[i + 1]);
+        }
+        return res * lcs[k].power(d[k - 1]);
+    }
+
+    /*
+     * Berlekamp-Massey algorithm
+     * Given a_0, a_1, ..., a_{N-1} finds the shortest linear recurrence
+     * a_n = c_1 * a_{n-1} + c_2 * a_{n-2} + ... + c_L * a_{n-L}
+     * Returns Q(x) = 1 - (c_1 * x + c_2 * x^2 + ... + c_L * x^L) of size L + 1
+     * The recurrence is unique if N >= 2L
+     * Complexity: O(N^2)
+     */
+    friend polynom_t BerlekampMassey(const polynom_t& a) {
+        int n = a.size(), len = 0, shift = 1;
+        // Reversed sequence turns discrepancy into a dot product of contiguous arrays
+        vm ra(a.data.rbegin(), a.data.rend()), cur(1, 1), prev(1, 1);
+        mint prev_d = 1;
+        for (int i = 0; i < n; ++i) {
+            // d = sum_{j <= len} cur_j * a_{i - j}
+            mint d = dot_product(cur.data(), ra.data() + n - 1 - i, len + 1);
+            if (d == 0) {
+                ++shift;
+                continue;
+            }
+            mint coef = d / prev_d;
+            vm old = cur;
+            int new_len = 2 * len <= i ? i + 1 - len : len;
+            cur.resize(std::max<int>(new_len + 1, prev.size() + shift));
+            for (int j = 0; j < static_cast<int>(prev.size()); ++j) cur[j + shift] -= coef * prev[j];
+            if (new_len != len) {
+                prev = old, prev_d = d, shift = 1;
+                len = new_len;
+            } else {
+                ++shift;
+            }
+        }
+        cur.resize(len + 1);
+        return cur;
+    }
+
+    /*
+     * Finds a shortest Q(x) by Half-GCD, it equals the one of BerlekampMassey when N >= 2L,
+     * otherwise the shortest recurrence is not unique and the two may differ
+     * P(x) / Q(x) = A(x) mod x^N is the first remainder of degree < (N + 1) / 2
+     * in Euclidean algorithm for x^N and A(x)
+     * Falls back to BerlekampMassey if the recurrence is longer than N / 2
+     * Complexity: O(N log^2 N)
+     */
+    friend polynom_t BerlekampMasseyHalfGCD(const polynom_t& a) {
+        int n = a.size();
+        polynom_t xn(n + 1), b(a);
+        xn[n] = 1, b.shrink();
+        poly_pair p = {xn, b};
+        poly_matrix m = half_gcd(p);
+        p = euclid_apply(m, p);
+        polynom_t& q = m[3];
+        if (q[0] == 0) return BerlekampMassey(a);
+        int len = std::max(q.deg(), p[1].deg() + 1);
+        q /= q[0];
+        q.resize(len + 1);
+        return q;
+    }
+
+    // Sequences longer than BM_HGCD_SZ_ use Half-GCD version of Berlekamp-Massey
+    constexpr static int BM_HGCD_SZ_ = 8000;
+
+    /*
+     * Given a_0, a_1, ..., a_{N-1} finds P(x) / Q(x) = a_0 + a_1 * x + a_2 * x^2 + ...
+     * with the shortest Q, result is ready to be passed to BostanMori
+     */
+    friend std::pair<polynom_t, polynom_t> find_recurrence(const polynom_t& a) {
+        polynom_t q = a.size() > BM_HGCD_SZ_ ? BerlekampMasseyHalfGCD(a) : BerlekampMassey(a);
+        int len = q.size() - 1;
+        polynom_t p = a;
+        p.resize(len);
+        p = p * q;
+        p.resize(len);
+        return {p, q};
+    }
+
+    /*
+     * n-th term of a linear recurrence given by its first terms a_0, a_1, ..., a_{N-1}
+     * Complexity: O(N^2 + L log L log n) for N <= BM_HGCD_SZ_, O(N log^2 N + L log L log n)
+     * above it, L is the length of the recurrence
+     */
+    template <class T>
+    friend mint recurrence_nth(const polynom_t& a, T n) {
+        static_assert(std::is_integral<T>::value);
+        auto [p, q] = find_recurrence(a);
+        if (q.size() == 1) return 0;
+        return BostanMori(p, q, n);
+    }
 };
 
+using polynom = polynom_t<mint>;
+
+// Polynoms modulo 2^64 - 2^32 + 1 for convolutions longer than 2^23
+using polynom64 = polynom_t<mint64>;
+
 #endif /* NTT */
\ No newline at end of file
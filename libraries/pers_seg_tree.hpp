@@ -1,95 +1,176 @@
 #ifndef PERS_SEG_TREE
 #define PERS_SEG_TREE
 
-#include <array>
-#include <cassert>
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 
+#include "chunked_arena.hpp"
+
 /**
  * Zero-indexed persistent segment tree
  * Intervals is expected to be [l, r)
  * 0 <= l < r <= n
+ * Nodes live in a chunked_arena_t, children are 32-bit indices and 0 is null, dropped
+ * versions are freed by compact
+ * Range add is enabled by RANGE_ADD, which adds a tag to every node (a node of int grows
+ * from 12 to 16 bytes); tags are permanent: a tag is never pushed, val of a node includes its
+ * own tag and queries add tags of ancestors on the way down, so f must be the sum
+ * Complexity: O(log n) time and new nodes per set and upd, O(log n) per get
  */
 
-template <class T>
+template <class T, bool RANGE_ADD = false>
 class persegtree {
    private:
-    struct node {
-        node* left = nullptr;
-        node* right = nullptr;
+    struct plain_node {
+        uint32_t left = 0;
+        uint32_t right = 0;
         T val;
 
-        node() = default;
-        node(const T& x) : val(x) {}
+        plain_node() = default;
+        plain_node(const T& x) : val(x) {}
     };
 
+    struct tagged_node : plain_node {
+        T tag = 0;
+
+        using plain_node::plain_node;
+    };
+
+    using node = std::conditional_t<RANGE_ADD, tagged_node, plain_node>;
+
     int n;
-    using nodeptr = node*;
-    std::vector<nodeptr> vers;
-    // q * log n
-    constexpr static size_t MAX_NODES = 3e5 * 19 + 228;
-    size_t _nodes_cnt = 0;
-    std::array<node, MAX_NODES> _storage;
+    std::vector<uint32_t> vers;
+    chunked_arena_t<node> _storage;
+
+    node& at(uint32_t u) { return _storage[u]; }
 
     // Create a node
-    nodeptr create(const T& val = nullval) {
-        _storage[_nodes_cnt] = node(val);
-        assert(_nodes_cnt < MAX_NODES);
-        return &_storage[_nodes_cnt++];
+    uint32_t create(const node& x) { return _storage.create(x); }
+
+    uint32_t build(int lo, int hi, const std::vector<T>& a) {
+        uint32_t u = create(node(nullval));
+        if (lo + 1 == hi) {
+            at(u).val = a[lo];
+            return u;
+        }
+        int mid = (lo + hi) / 2;
+        uint32_t left = build(lo, mid, a), right = build(mid, hi, a);
+        at(u).left = left, at(u).right = right;
+        at(u).val = f(at(left).val, at(right).val);
+        return u;
     }
 
-    nodeptr copy(const nodeptr& u) {
-        _storage[_nodes_cnt] = node(*u);
-        assert(_nodes_cnt < MAX_NODES);
-        return &_storage[_nodes_cnt++];
+    T get_val(uint32_t u) { return u == 0 ? nullval : at(u).val; }
+
+    // Recomputes val of an inner node from its children and its own tag
+    void pull(uint32_t u, int lo, int hi) {
+        node& x = at(u);
+        x.val = f(get_val(x.left), get_val(x.right));
+        if constexpr (RANGE_ADD) x.val += x.tag * (hi - lo);
     }
 
-    nodeptr build(int lo, int hi, const std::vector<T>& a) {
-        nodeptr u = create();
+    // acc is the sum of tags of proper ancestors, the leaf compensates for it
+    uint32_t set(uint32_t u, int lo, int hi, int p, const T& x, T acc) {
+        u = create(at(u));
         if (lo + 1 == hi) {
-            u->val = a[lo];
+            if constexpr (RANGE_ADD)
+                at(u).val = x - acc, at(u).tag = 0;
+            else
+                at(u).val = x;
             return u;
         }
         int mid = (lo + hi) / 2;
-        u->left = build(lo, mid, a);
-        u->right = build(mid, hi, a);
-        u->val = f(u->left->val, u->right->val);
+        if constexpr (RANGE_ADD) acc += at(u).tag;
+        if (p < mid) {
+            uint32_t left = set(at(u).left, lo, mid, p, x, acc);
+            at(u).left = left;
+        } else {
+            uint32_t right = set(at(u).right, mid, hi, p, x, acc);
+            at(u).right = right;
+        }
+        pull(u, lo, hi);
         return u;
     }
 
-    T get_val(const nodeptr& u) { return u == nullptr ? nullval : u->val; }
+    uint32_t upd(uint32_t u, int lo, int hi, int l, int r, const T& delta) {
+        if (r <= lo || hi <= l) return u;
+        u = create(at(u));
+        if (l <= lo && hi <= r) {
+            at(u).tag += delta, at(u).val += delta * (hi - lo);
+            return u;
+        }
+        int mid = (lo + hi) / 2;
+        uint32_t left = upd(at(u).left, lo, mid, l, r, delta);
+        uint32_t right = upd(at(u).right, mid, hi, l, r, delta);
+        at(u).left = left, at(u).right = right;
+        pull(u, lo, hi);
+        return u;
+    }
+
+    T get(uint32_t u, int lo, int hi, int l, int r, T acc) {
+        if (u == 0 || r <= lo || hi <= l) return T(nullval);
+        if (l <= lo && hi <= r) {
+            if constexpr (RANGE_ADD) return at(u).val + acc * (hi - lo);
+            return at(u).val;
+        }
+        int mid = (lo + hi) / 2;
+        if constexpr (RANGE_ADD) acc += at(u).tag;
+        return f(get(at(u).left, lo, mid, l, r, acc), get(at(u).right, mid, hi, l, r, acc));
+    }
+
+    // Copies the subtree of u from old arena once, remap holds new indices of copied nodes
+    uint32_t copy_reachable(const chunked_arena_t<node>& old, std::vector<uint32_t>& remap,
+                            uint32_t u) {
+        if (u == 0 || remap[u]) return remap[u];
+        const node& src = old[u];
+        uint32_t v = create(src);
+        remap[u] = v;
+        uint32_t left = copy_reachable(old, remap, src.left);
+        uint32_t right = copy_reachable(old, remap, src.right);
+        at(v).left = left, at(v).right = right;
+        return v;
+    }
 
    public:
     constexpr static T nullval = 0;
 
     T f(const T& x, const T& y) { return x + y; }
 
-    persegtree(const std::vector<T>& a) : n(a.size()) { vers.push_back(build(0, n, a)); }
+    // capacity is the expected number of nodes, about 2n + q log n for q sets, 4 q log n for
+    // q range adds
+    persegtree(const std::vector<T>& a, size_t capacity = 0) : n(a.size()) {
+        _storage.reserve(capacity + 1);
+        vers.push_back(build(0, n, a));
+    }
 
-    void set(int v, int p, const T& x) { vers.push_back(set(vers[v], 0, n, p, x)); }
+    // New version equal to version v with x at position p
+    void set(int v, int p, const T& x) { vers.push_back(set(vers[v], 0, n, p, x, 0)); }
 
-    nodeptr set(nodeptr u, int lo, int hi, int p, const T& x) {
-        u = copy(u);
-        if (lo + 1 == hi) {
-            u->val = x;
-            return u;
-        }
-        int mid = (lo + hi) / 2;
-        if (p < mid)
-            u->left = set(u->left, lo, mid, p, x);
-        else
-            u->right = set(u->right, mid, hi, p, x);
-        u->val = f(get_val(u->left), get_val(u->right));
-        return u;
+    // New version equal to version v with delta added on segment [l, r), needs RANGE_ADD
+    void upd(int v, int l, int r, const T& delta) {
+        static_assert(RANGE_ADD, "range add needs persegtree<T, true>");
+        vers.push_back(upd(vers[v], 0, n, l, r, delta));
     }
 
-    T get(int v, int l, int r) { return get(vers[v], 0, n, l, r); }
+    // Get f of elements on segment [l, r) in version v
+    T get(int v, int l, int r) { return get(vers[v], 0, n, l, r, 0); }
 
-    T get(nodeptr u, int lo, int hi, int l, int r) {
-        if (u == nullptr || r <= lo || hi <= l) return T(nullval);
-        if (l <= lo && hi <= r) return u->val;
-        int mid = (lo + hi) / 2;
-        return f(get(u->left, lo, mid, l, r), get(u->right, mid, hi, l, r));
+    int versions() const { return vers.size(); }
+
+    // Number of nodes in the arena, including unreachable ones before compact
+    size_t node_count() const { return _storage.size(); }
+
+    // Version v will not be used anymore, its nodes are freed by the next compact
+    void drop(int v) { vers[v] = 0; }
+
+    // Moves nodes reachable from versions that are not dropped into a fresh arena,
+    // version numbers are kept
+    void compact() {
+        chunked_arena_t<node> old;
+        old.swap(_storage);
+        std::vector<uint32_t> remap(old.size() + 1, 0);
+        for (auto& root : vers) root = copy_reachable(old, remap, root);
     }
 };
 
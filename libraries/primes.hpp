@@ -0,0 +1,285 @@
+#ifndef PRIMES
+#define PRIMES
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "modular.hpp"
+
+/*
+ * Primes up to n, linear sieve
+ * Complexity: O(n)
+ */
+std::vector<int> primes_up_to(int n) {
+    std::vector<int> primes, lp(n + 1);
+    for (int i = 2; i <= n; ++i) {
+        if (lp[i] == 0) lp[i] = i, primes.push_back(i);
+        for (int j = 0; j < static_cast<int>(primes.size()) && primes[j] <= lp[i] &&
+                        static_cast<int64_t>(i) * primes[j] <= n;
+             ++j)
+            lp[i * primes[j]] = primes[j];
+    }
+    return primes;
+}
+
+// Floor of square root of n < 2^63
+int64_t isqrt(int64_t n) {
+    int64_t r = std::sqrt(static_cast<double>(n));
+    while (r * r > n) --r;
+    while ((r + 1) * (r + 1) <= n) ++r;
+    return r;
+}
+
+/*
+ * All distinct values floor(n / i), about 2 sqrt(n) of them, vals is decreasing
+ * index(v) is the position of v in vals, small and large values are kept in separate arrays
+ */
+struct floor_values_t {
+    int64_t n;
+    int sq;
+    std::vector<int64_t> vals;
+    std::vector<int> small, large;
+
+    explicit floor_values_t(int64_t n) : n(n), sq(isqrt(n)), small(sq + 1), large(sq + 1) {
+        for (int64_t i = 1; i <= n; i = n / (n / i) + 1) {
+            int64_t v = n / i;
+            (v <= sq ? small[v] : large[n / v]) = vals.size();
+            vals.push_back(v);
+        }
+    }
+
+    int size() const { return vals.size(); }
+
+    // v must be of form floor(n / i)
+    int index(int64_t v) const { return v <= sq ? small[v] : large[n / v]; }
+};
+
+// Converts nonnegative x to integral T or to modular integer T
+template <class T>
+T from_u128_(unsigned __int128 x) {
+    if constexpr (std::is_arithmetic<T>::value || std::is_same<T, __int128>::value)
+        return static_cast<T>(x);
+    else
+        return T(static_cast<int64_t>(x % T::get_mod()));
+}
+
+/*
+ * Lucy_Hedgehog sieve: res[i] = sum of p^k over primes p <= vals[i], 0 <= k <= 2
+ * After processing prime p, g(v) holds the sum over numbers that are primes or have all
+ * prime factors greater than p: g(v) -= p^k * (g(v / p) - g(p - 1)) for v >= p^2
+ * T is an integer type wide enough for the sums or a modular integer
+ * Complexity: O(n^{3/4} / log n)
+ */
+template <class T>
+std::vector<T> lucy_prime_sums(const floor_values_t& fv, const std::vector<int>& primes, int k) {
+    assert(0 <= k && k <= 2);
+    std::vector<T> g(fv.size());
+    for (int i = 0; i < fv.size(); ++i) {
+        unsigned __int128 v = fv.vals[i];
+        // Sum of i^k for 2 <= i <= v
+        unsigned __int128 s = k == 0 ? v : k == 1 ? v * (v + 1) / 2 : v * (v + 1) / 2 * (2 * v + 1) / 3;
+        g[i] = from_u128_<T>(s - 1);
+    }
+    for (int p : primes) {
+        int64_t p2 = static_cast<int64_t>(p) * p;
+        if (p2 > fv.n) break;
+        T pk = k == 0 ? T(1) : k == 1 ? T(p) : T(p2), gp = g[fv.index(p - 1)];
+        for (int i = 0; i < fv.size() && fv.vals[i] >= p2; ++i)
+            g[i] -= pk * (g[fv.index(fv.vals[i] / p)] - gp);
+    }
+    return g;
+}
+
+/*
+ * Min_25 sieve: sum of multiplicative f(i) for 1 <= i <= n
+ * prime_f[i] = sum of f(p) over primes p <= vals[i], f_pe(p, e, p^e) = f(p^e)
+ * primes must contain all primes up to sqrt(n)
+ * S(x, j) = sum of f(i) for 2 <= i <= x with the smallest prime factor at least primes[j]:
+ * S(x, j) = F(x) - F(primes[j] - 1) + sum_{k >= j, e >= 1, p_k^{e+1} <= x}
+ *           f(p_k^e) S(x / p_k^e, k + 1) + f(p_k^{e+1})
+ * Complexity: O(n^{3/4} / log n) in practice
+ */
+template <class T, class Fpe>
+T min25_sum(const floor_values_t& fv, const std::vector<int>& primes, const std::vector<T>& prime_f,
+            const Fpe& f_pe) {
+    auto rec = [&](auto&& self, int64_t x, int j) -> T {
+        if (j > 0 && primes[j - 1] >= x) return T(0);
+        T res = prime_f[fv.index(x)];
+        if (j > 0) res -= prime_f[fv.index(primes[j - 1])];
+        for (int k = j; k < static_cast<int>(primes.size()) &&
+                        static_cast<int64_t>(primes[k]) * primes[k] <= x;
+             ++k) {
+            int64_t p = primes[k], pe = p;
+            for (int e = 1; pe * p <= x; ++e, pe *= p)
+                res += f_pe(p, e, pe) * self(self, x / pe, k + 1) + f_pe(p, e + 1, pe * p);
+        }
+        return res;
+    };
+    return rec(rec, fv.n, 0) + T(1);
+}
+
+/*
+ * Number of primes up to n
+ * Complexity: O(n^{3/4} / log n)
+ */
+int64_t prime_pi(int64_t n) {
+    if (n < 2) return 0;
+    floor_values_t fv(n);
+    return lucy_prime_sums<int64_t>(fv, primes_up_to(fv.sq), 0)[0];
+}
+
+/*
+ * Sum of primes up to n, T must hold values up to n^2 / 2 or be a modular integer
+ * Complexity: O(n^{3/4} / log n)
+ */
+template <class T>
+T prime_sum(int64_t n) {
+    if (n < 2) return T(0);
+    floor_values_t fv(n);
+    return lucy_prime_sums<T>(fv, primes_up_to(fv.sq), 1)[0];
+}
+
+/*
+ * Sum of Euler's totient phi(i) for 1 <= i <= n, phi(p) = p - 1, phi(p^e) = p^{e-1} (p - 1)
+ * T must hold values up to 3n^2 / pi^2 or be a modular integer
+ * Complexity: O(n^{3/4} / log n) in practice
+ */
+template <class T>
+T totient_sum(int64_t n) {
+    if (n < 1) return T(0);
+    floor_values_t fv(n);
+    std::vector<int> primes = primes_up_to(fv.sq);
+    std::vector<T> s0 = lucy_prime_sums<T>(fv, primes, 0), s1 = lucy_prime_sums<T>(fv, primes, 1);
+    for (int i = 0; i < fv.size(); ++i) s1[i] -= s0[i];
+    return min25_sum<T>(fv, primes, s1,
+                        [](int64_t p, int, int64_t pe) { return from_u128_<T>(pe / p * (p - 1)); });
+}
+
+/*
+ * Segmented sieve of Eratosthenes on odd numbers of [l, r), calls fn(seg_id, lo, bits) for
+ * every segment [lo, lo + 2 SIEVE_SEG_BITS_), bit i of bits is set iff lo + 2i + 1 is prime
+ * A segment bitset fits into L1 cache, every thread sieves a contiguous run of segments and
+ * keeps the next multiple of each base prime, so no divisions are done per segment
+ * fn must be safe to call concurrently for different segments
+ * Complexity: O((r - l) log log r + sqrt(r)) work
+ */
+constexpr int64_t SIEVE_SEG_BITS_ = 1 << 18;
+
+/*
+ * Odd numbers with no factor among 3, 5, 7, 11, 13 repeat with period 15015 in bit indices,
+ * words[o] holds 64 bits of that pattern starting at offset o, a segment is filled from it
+ * instead of crossing out the five smallest primes
+ */
+struct sieve_pattern_t {
+    static constexpr int PERIOD = 3 * 5 * 7 * 11 * 13, CNT = 5;
+    std::vector<uint64_t> words;
+
+    sieve_pattern_t() : words(PERIOD) {
+        std::vector<bool> keep(2 * PERIOD);
+        for (int i = 0; i < 2 * PERIOD; ++i) {
+            int v = 2 * i + 1;
+            keep[i] = v % 3 && v % 5 && v % 7 && v % 11 && v % 13;
+        }
+        for (int o = 0; o < PERIOD; ++o)
+            for (int b = 0; b < 64; ++b)
+                if (keep[o + b]) words[o] |= 1ULL << b;
+    }
+};
+
+template <class Fn>
+int64_t sieve_segments(int64_t l, int64_t r, int threads, const Fn& fn) {
+    const int64_t seg_len = 2 * SIEVE_SEG_BITS_, lo0 = l / seg_len * seg_len;
+    const int64_t segs = r > l ? (r - lo0 + seg_len - 1) / seg_len : 0;
+    const std::vector<int> base = primes_up_to(isqrt(std::max<int64_t>(r, 1)));
+    threads = std::max<int>(1, std::min<int64_t>(threads, segs));
+    static const sieve_pattern_t pattern;
+    const bool use_pattern = base.size() > sieve_pattern_t::CNT;
+    auto work = [&](int t) {
+        const int64_t s0 = segs * t / threads, s1 = segs * (t + 1) / threads;
+        // Bit index of the next odd multiple of base[k] to cross out, counted from lo0
+        std::vector<int64_t> next(base.size());
+        for (size_t k = 1; k < base.size(); ++k) {
+            const int64_t p = base[k];
+            int64_t start = std::max(p * p, (lo0 + s0 * seg_len + p) / p * p);
+            if (start % 2 == 0) start += p;
+            next[k] = (start - lo0 - 1) / 2;
+        }
+        std::vector<uint64_t> bits(SIEVE_SEG_BITS_ / 64);
+        for (int64_t s = s0; s < s1; ++s) {
+            const int64_t lo = lo0 + s * seg_len, first = s * SIEVE_SEG_BITS_;
+            size_t k = 1;
+            if (use_pattern) {
+                // Bit i stands for lo + 2i + 1, its offset in the pattern is (lo / 2 + i) mod PERIOD
+                int o = (lo / 2) % sieve_pattern_t::PERIOD;
+                for (auto& w : bits) {
+                    w = pattern.words[o];
+                    o += 64;
+                    if (o >= sieve_pattern_t::PERIOD) o -= sieve_pattern_t::PERIOD;
+                }
+                for (int p : {3, 5, 7, 11, 13})
+                    if (lo < p && p < lo + seg_len) bits[(p - lo) / 2 / 64] |= 1ULL << ((p - lo) / 2 % 64);
+                k += sieve_pattern_t::CNT;
+            } else {
+                std::fill(bits.begin(), bits.end(), ~0ULL);
+            }
+            for (; k < base.size(); ++k) {
+                const int64_t p = base[k];
+                if (p * p >= lo + seg_len) break;
+                int64_t i = next[k] - first;
+                for (; i < SIEVE_SEG_BITS_; i += p) bits[i / 64] &= ~(1ULL << (i % 64));
+                next[k] = i + first;
+            }
+            // Odd numbers lo + 2i + 1 outside [max(l, 3), r) are not reported
+            for (int64_t i = 0; i < SIEVE_SEG_BITS_ && (lo + 2 * i + 1 < l || lo + 2 * i + 1 < 3); ++i)
+                bits[i / 64] &= ~(1ULL << (i % 64));
+            for (int64_t i = SIEVE_SEG_BITS_ - 1; i >= 0 && lo + 2 * i + 1 >= r; --i)
+                bits[i / 64] &= ~(1ULL << (i % 64));
+            fn(s, lo, bits);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto& th : pool) th.join();
+    return segs;
+}
+
+/*
+ * Primes in [l, r) in increasing order, segments are sieved by threads in parallel
+ * Complexity: O((r - l) log log r + sqrt(r)) work
+ */
+std::vector<int64_t> primes_in_range(int64_t l, int64_t r, int threads = 1) {
+    const int64_t seg_len = 2 * SIEVE_SEG_BITS_;
+    std::vector<std::vector<int64_t>> found(r > l ? (r - l / seg_len * seg_len) / seg_len + 1 : 0);
+    sieve_segments(l, r, threads, [&](int64_t s, int64_t lo, const std::vector<uint64_t>& bits) {
+        for (size_t w = 0; w < bits.size(); ++w)
+            for (uint64_t b = bits[w]; b; b &= b - 1)
+                found[s].push_back(lo + 2 * (64 * w + __builtin_ctzll(b)) + 1);
+    });
+    std::vector<int64_t> res;
+    if (l <= 2 && 2 < r) res.push_back(2);
+    for (auto& f : found) res.insert(res.end(), f.begin(), f.end());
+    return res;
+}
+
+/*
+ * Number of primes in [l, r)
+ * Complexity: O((r - l) log log r + sqrt(r)) work
+ */
+int64_t count_primes_in_range(int64_t l, int64_t r, int threads = 1) {
+    const int64_t seg_len = 2 * SIEVE_SEG_BITS_;
+    std::vector<int64_t> cnt(r > l ? (r - l / seg_len * seg_len) / seg_len + 1 : 0);
+    sieve_segments(l, r, threads, [&](int64_t s, int64_t, const std::vector<uint64_t>& bits) {
+        for (uint64_t b : bits) cnt[s] += __builtin_popcountll(b);
+    });
+    int64_t res = l <= 2 && 2 < r;
+    for (int64_t c : cnt) res += c;
+    return res;
+}
+
+#endif /* PRIMES */
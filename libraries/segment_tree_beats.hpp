@@ -0,0 +1,196 @@
+#ifndef SEGMENT_TREE_BEATS
+#define SEGMENT_TREE_BEATS
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/**
+ * Zero-indexed segment tree beats (Ji Ruyi)
+ * a[i] = min(a[i], x), a[i] = max(a[i], x), a[i] += x on segment; sum, max, min on segment
+ * Every node keeps the maximum, the strict second maximum and the count of maxima (and the
+ * same for minimum), chmin is a tag while x is above the second maximum, otherwise
+ * the update recurses, which happens O((n + q) log n) times in total
+ * Intervals is expected to be [l, r)
+ * 0 <= l < r <= n
+ * T must hold sums of the whole array
+ * Complexity: O(log^2 n) amortized per update, O(log n) per query
+ */
+template <class T>
+class segment_tree_beats_t {
+   private:
+    static constexpr T INF = std::numeric_limits<T>::max();
+    static constexpr T NINF = std::numeric_limits<T>::lowest();
+
+    struct node_t {
+        T sum, max1, max2, min1, min2, add;
+        int cnt_max, cnt_min, len;
+    };
+
+    int n;
+    std::vector<node_t> tr;
+
+    static void pull(node_t& v, const node_t& a, const node_t& b) {
+        v.sum = a.sum + b.sum;
+        if (a.max1 == b.max1) {
+            v.max1 = a.max1, v.max2 = std::max(a.max2, b.max2), v.cnt_max = a.cnt_max + b.cnt_max;
+        } else if (a.max1 > b.max1) {
+            v.max1 = a.max1, v.max2 = std::max(a.max2, b.max1), v.cnt_max = a.cnt_max;
+        } else {
+            v.max1 = b.max1, v.max2 = std::max(a.max1, b.max2), v.cnt_max = b.cnt_max;
+        }
+        if (a.min1 == b.min1) {
+            v.min1 = a.min1, v.min2 = std::min(a.min2, b.min2), v.cnt_min = a.cnt_min + b.cnt_min;
+        } else if (a.min1 < b.min1) {
+            v.min1 = a.min1, v.min2 = std::min(a.min2, b.min1), v.cnt_min = a.cnt_min;
+        } else {
+            v.min1 = b.min1, v.min2 = std::min(a.min1, b.min2), v.cnt_min = b.cnt_min;
+        }
+    }
+
+    void pull(int id) { pull(tr[id], tr[id * 2 + 1], tr[id * 2 + 2]); }
+
+    void build(const std::vector<T>& vec, int id, int lo, int hi) {
+        tr[id].len = hi - lo, tr[id].add = 0;
+        if (lo + 1 == hi) {
+            tr[id].sum = tr[id].max1 = tr[id].min1 = vec[lo];
+            tr[id].max2 = NINF, tr[id].min2 = INF;
+            tr[id].cnt_max = tr[id].cnt_min = 1;
+            return;
+        }
+        int mid = (lo + hi) / 2;
+        build(vec, id * 2 + 1, lo, mid);
+        build(vec, id * 2 + 2, mid, hi);
+        pull(id);
+    }
+
+    void apply_add(int id, const T& x) {
+        node_t& v = tr[id];
+        v.sum += x * v.len, v.add += x;
+        v.max1 += x, v.min1 += x;
+        if (v.max2 != NINF) v.max2 += x;
+        if (v.min2 != INF) v.min2 += x;
+    }
+
+    // Lowers maxima to x, requires max2 < x
+    void apply_chmin(int id, const T& x) {
+        node_t& v = tr[id];
+        if (v.max1 <= x) return;
+        v.sum -= (v.max1 - x) * v.cnt_max;
+        // With one or two distinct values the maxima are also minima
+        if (v.min1 == v.max1)
+            v.min1 = x;
+        else if (v.min2 == v.max1)
+            v.min2 = x;
+        v.max1 = x;
+    }
+
+    // Raises minima to x, requires min2 > x
+    void apply_chmax(int id, const T& x) {
+        node_t& v = tr[id];
+        if (v.min1 >= x) return;
+        v.sum += (x - v.min1) * v.cnt_min;
+        if (v.max1 == v.min1)
+            v.max1 = x;
+        else if (v.max2 == v.min1)
+            v.max2 = x;
+        v.min1 = x;
+    }
+
+    void push(int id) {
+        for (int c = id * 2 + 1; c <= id * 2 + 2; ++c) {
+            if (tr[id].add != 0) apply_add(c, tr[id].add);
+            apply_chmin(c, tr[id].max1);
+            apply_chmax(c, tr[id].min1);
+        }
+        tr[id].add = 0;
+    }
+
+    void chmin(int id, int lo, int hi, int l, int r, const T& x) {
+        if (r <= lo || hi <= l || tr[id].max1 <= x) return;
+        if (l <= lo && hi <= r && tr[id].max2 < x) {
+            apply_chmin(id, x);
+            return;
+        }
+        push(id);
+        int mid = (lo + hi) / 2;
+        chmin(id * 2 + 1, lo, mid, l, r, x);
+        chmin(id * 2 + 2, mid, hi, l, r, x);
+        pull(id);
+    }
+
+    void chmax(int id, int lo, int hi, int l, int r, const T& x) {
+        if (r <= lo || hi <= l || tr[id].min1 >= x) return;
+        if (l <= lo && hi <= r && tr[id].min2 > x) {
+            apply_chmax(id, x);
+            return;
+        }
+        push(id);
+        int mid = (lo + hi) / 2;
+        chmax(id * 2 + 1, lo, mid, l, r, x);
+        chmax(id * 2 + 2, mid, hi, l, r, x);
+        pull(id);
+    }
+
+    void add(int id, int lo, int hi, int l, int r, const T& x) {
+        if (r <= lo || hi <= l) return;
+        if (l <= lo && hi <= r) {
+            apply_add(id, x);
+            return;
+        }
+        push(id);
+        int mid = (lo + hi) / 2;
+        add(id * 2 + 1, lo, mid, l, r, x);
+        add(id * 2 + 2, mid, hi, l, r, x);
+        pull(id);
+    }
+
+    // Sum of maximums, minimums and sums of nodes covering [l, r)
+    void get(int id, int lo, int hi, int l, int r, node_t& res) {
+        if (r <= lo || hi <= l) return;
+        if (l <= lo && hi <= r) {
+            res.sum += tr[id].sum;
+            res.max1 = std::max(res.max1, tr[id].max1);
+            res.min1 = std::min(res.min1, tr[id].min1);
+            return;
+        }
+        push(id);
+        int mid = (lo + hi) / 2;
+        get(id * 2 + 1, lo, mid, l, r, res);
+        get(id * 2 + 2, mid, hi, l, r, res);
+    }
+
+    node_t get(int l, int r) {
+        node_t res{};
+        res.sum = 0, res.max1 = NINF, res.min1 = INF;
+        get(0, 0, n, l, r, res);
+        return res;
+    }
+
+   public:
+    segment_tree_beats_t(const std::vector<T>& vec) : n(vec.size()), tr(4 * n) {
+        build(vec, 0, 0, n);
+    }
+
+    segment_tree_beats_t(int n, const T& x = T()) : segment_tree_beats_t(std::vector<T>(n, x)) {}
+
+    // a[i] = min(a[i], x) on segment [l, r)
+    void chmin(int l, int r, const T& x) { chmin(0, 0, n, l, r, x); }
+
+    // a[i] = max(a[i], x) on segment [l, r)
+    void chmax(int l, int r, const T& x) { chmax(0, 0, n, l, r, x); }
+
+    // a[i] += x on segment [l, r)
+    void add(int l, int r, const T& x) { add(0, 0, n, l, r, x); }
+
+    // Sum of elements on segment [l, r)
+    T get_sum(int l, int r) { return get(l, r).sum; }
+
+    // Max of elements on segment [l, r)
+    T get_max(int l, int r) { return get(l, r).max1; }
+
+    // Min of elements on segment [l, r)
+    T get_min(int l, int r) { return get(l, r).min1; }
+};
+
+#endif /* SEGMENT_TREE_BEATS */
@@ -2,18 +2,77 @@
 #define SEGMENT_TREE_FAST
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+/*
+ * Monoid policies: value_type, associative static op and its identity id()
+ * op does not need to be commutative
+ */
+template <class T>
+struct max_monoid {
+    using value_type = T;
+    static constexpr T id() { return std::numeric_limits<T>::min(); }
+    static constexpr T op(const T& x, const T& y) { return std::max(x, y); }
+};
+
+template <class T>
+struct min_monoid {
+    using value_type = T;
+    static constexpr T id() { return std::numeric_limits<T>::max(); }
+    static constexpr T op(const T& x, const T& y) { return std::min(x, y); }
+};
+
+template <class T>
+struct sum_monoid {
+    using value_type = T;
+    static constexpr T id() { return T(); }
+    static constexpr T op(const T& x, const T& y) { return x + y; }
+};
+
+// segment_tree_t<T> for a plain value type T keeps the old behaviour: max on segment
+template <class M, class = void>
+struct as_monoid_ {
+    using type = max_monoid<M>;
+};
+
+template <class M>
+struct as_monoid_<M, std::void_t<decltype(M::id())>> {
+    using type = M;
+};
+
+// Batches of independent node recomputations or queries smaller than this stay on one thread
+constexpr size_t SEGMENT_TREE_GRAIN_ = 1 << 14;
+
+// Calls fn(b, e) on parts of [0, cnt) in at most threads threads
+template <class Fn>
+void parallel_ranges_(size_t cnt, int threads, const Fn& fn) {
+    threads = std::max<int>(1, std::min<size_t>(threads, cnt / SEGMENT_TREE_GRAIN_));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(fn, cnt * t / threads, cnt * (t + 1) / threads);
+    fn(0, cnt / threads);
+    for (auto& th : pool) th.join();
+}
+
 /**
  * Zero-indexed non-recursive segment tree
- * max on segment, set val at pos
+ * Monoid::op on segment, set val at pos
  * Intervals is expected to be [l, r)
  * 0 <= l < r <= n
  * The constant factor is lower, than at recursive version
  */
-template <class T>
+template <class Monoid>
 class segment_tree_t {
+   public:
+    using M = typename as_monoid_<Monoid>::type;
+    using T = typename M::value_type;
+
    private:
     int n;
     std::vector<T> tr;
@@ -24,40 +83,208 @@ class segment_tree_t {
 
     void build(const std::vector<T>& vec) {
         for (int i = 0; i < n; ++i) tr[i + n] = vec[i];
-        for (int id = n - 1; id >= 0; --id) tr[id] = f(tr[id * 2 + 0], tr[id * 2 + 1]);
+        for (int id = n - 1; id > 0; --id) tr[id] = M::op(tr[id * 2 + 0], tr[id * 2 + 1]);
     }
 
-   public:
-    T nullval = std::numeric_limits<T>::min();
+    // Canonical nodes of [l, r) from left to right, returns their count, res holds up to 64 nodes
+    // Each of them is a root of a perfect subtree of leaves, so it can be descended into
+    int nodes_of(int l, int r, int* res) const {
+        int cnt = 0, rcnt = 0, rev[32];
+        for (l += n, r += n; l < r; l /= 2, r /= 2) {
+            if (l & 1) res[cnt++] = l++;
+            if (r & 1) rev[rcnt++] = --r;
+        }
+        while (rcnt > 0) res[cnt++] = rev[--rcnt];
+        return cnt;
+    }
 
-    T f(const T& x, const T& y) { return std::max(x, y); }
+    // Recomputes ancestors of leaf pos, left child always goes first
+    void pull(int pos) {
+        for (pos += n; pos > 1; pos /= 2) tr[pos / 2] = M::op(tr[pos & ~1], tr[pos | 1]);
+    }
 
-    segment_tree_t(int n) : n(n), tr(2 * n) {}
+   public:
+    segment_tree_t(int n) : n(n), tr(2 * n, M::id()) {}
 
     segment_tree_t(const std::vector<T>& vec) : segment_tree_t(vec.size()) { build(vec); }
 
     segment_tree_t(int n, const T& x) : segment_tree_t(std::vector<T>(n, x)) {}
 
-    // Get f of elements on segment [l, r)
+    int size() const { return n; }
+
+    // Get op of elements on segment [l, r) in order
     T get(int l, int r) {
         clamp(l), clamp(r);
-        if (l >= r) return nullval;
-        T resl = nullval, resr = nullval;
+        if (l >= r) return M::id();
+        T resl = M::id(), resr = M::id();
         for (l += n, r += n; l < r; l /= 2, r /= 2) {
-            if (l & 1) resl = f(resl, tr[l++]);
-            if (r & 1) resr = f(tr[--r], resr);
+            if (l & 1) resl = M::op(resl, tr[l++]);
+            if (r & 1) resr = M::op(tr[--r], resr);
+        }
+        return M::op(resl, resr);
+    }
+
+    /*
+     * Largest r >= l with pred(op of [l, r)) true, pred must be monotone and pred(id) true
+     * Canonical nodes of [l, n) are scanned left to right, then the first failing one is
+     * descended into
+     * Complexity: O(log n)
+     */
+    template <class Pred>
+    int max_right(int l, Pred pred) {
+        clamp(l);
+        int nodes[64], cnt = nodes_of(l, n, nodes);
+        T acc = M::id();
+        for (int i = 0; i < cnt; ++i) {
+            int v = nodes[i];
+            T nxt = M::op(acc, tr[v]);
+            if (pred(nxt)) {
+                acc = nxt;
+                continue;
+            }
+            while (v < n) {
+                v *= 2;
+                nxt = M::op(acc, tr[v]);
+                if (pred(nxt)) acc = nxt, ++v;
+            }
+            return v - n;
+        }
+        return n;
+    }
+
+    /*
+     * Smallest l <= r with pred(op of [l, r)) true, pred must be monotone and pred(id) true
+     * Complexity: O(log n)
+     */
+    template <class Pred>
+    int min_left(int r, Pred pred) {
+        clamp(r);
+        int nodes[64], cnt = nodes_of(0, r, nodes);
+        T acc = M::id();
+        for (int i = cnt - 1; i >= 0; --i) {
+            int v = nodes[i];
+            T nxt = M::op(tr[v], acc);
+            if (pred(nxt)) {
+                acc = nxt;
+                continue;
+            }
+            while (v < n) {
+                v = v * 2 + 1;
+                nxt = M::op(tr[v], acc);
+                if (pred(nxt)) acc = nxt, --v;
+            }
+            return v + 1 - n;
+        }
+        return 0;
+    }
+
+    /*
+     * Answers queries [l, r), results are in the order of queries
+     * Queries are answered in increasing order of (l, r), so consecutive ones share the cached
+     * upper part of their paths, then the results are scattered back; the order is found by
+     * stable LSD radix sort with 8-bit digits, first on r and then on l, of copies of the
+     * queries, so that every pass reads its input sequentially; sorted input skips the sort
+     * Complexity: O(q + q log n / threads)
+     */
+    std::vector<T> get_many(std::span<const std::pair<int, int>> queries, int threads = 1) {
+        struct item_ {
+            uint32_t l, r, i;
+        };
+        const size_t q = queries.size();
+        std::vector<T> res(q);
+        if (std::is_sorted(queries.begin(), queries.end())) {
+            parallel_ranges_(q, threads, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) res[i] = get(queries[i].first, queries[i].second);
+            });
+            return res;
+        }
+        std::vector<item_> items(q), tmp(q);
+        for (size_t i = 0; i < q; ++i) {
+            auto [l, r] = queries[i];
+            items[i] = {(uint32_t)std::min(std::max(0, l), n),
+                        (uint32_t)std::min(std::max(0, r), n), (uint32_t)i};
         }
-        return f(resl, resr);
+        auto by = [&](uint32_t item_::*key) {
+            // Keys are at most n, so digits above its highest bit are skipped
+            for (int shift = 0; shift == 0 || (shift < 32 && (n >> shift) > 0); shift += 8) {
+                size_t cnt[257] = {};
+                for (const item_& x : items) ++cnt[(x.*key >> shift & 0xFF) + 1];
+                for (int d = 0; d < 256; ++d) cnt[d + 1] += cnt[d];
+                for (const item_& x : items) tmp[cnt[x.*key >> shift & 0xFF]++] = x;
+                std::swap(items, tmp);
+            }
+        };
+        by(&item_::r);
+        by(&item_::l);
+        parallel_ranges_(q, threads, [&](size_t b, size_t e) {
+            for (size_t j = b; j < e; ++j) res[items[j].i] = get(items[j].l, items[j].r);
+        });
+        return res;
     }
 
+    /*
+     * Sets values at positions, later pairs win on equal positions
+     * Leaves are written first and their parents are marked in a bitset over inner nodes,
+     * then inner nodes are swept depth by depth (by the index in the implicit heap) from the
+     * bottom, every dirty one is recomputed once and marks its parent; nodes of one depth are
+     * roots of disjoint subtrees, so a large depth is split between threads at even words
+     * and their parents' bits never share a word
+     * Small batches fall back to set
+     * Complexity: O(n / 64 + k log(n / k)) for k updates
+     */
+    void set_many(std::span<const std::pair<int, T>> updates, int threads = 1) {
+        if (n <= 1 || updates.size() * 256 < static_cast<size_t>(n)) {
+            for (const auto& [pos, val] : updates) set(pos, val);
+            return;
+        }
+        std::vector<uint64_t> dirty(n / 64 + 1);
+        for (const auto& [pos, val] : updates) {
+            tr[pos + n] = val;
+            const int v = (pos + n) / 2;
+            dirty[v / 64] |= 1ULL << (v % 64);
+        }
+        auto sweep = [&](int lo, int hi, size_t w0, size_t w1) {
+            for (size_t w = w0; w < w1; ++w) {
+                uint64_t bits = dirty[w];
+                if (!bits) continue;
+                // Only nodes of the current depth, they may share a word with others for d < 6
+                if (static_cast<int64_t>(w * 64) < lo) bits &= ~0ULL << (lo - w * 64);
+                if (static_cast<int64_t>(w * 64 + 64) > hi) bits &= (1ULL << (hi - w * 64)) - 1;
+                dirty[w] &= ~bits;
+                for (; bits; bits &= bits - 1) {
+                    const int v = w * 64 + __builtin_ctzll(bits);
+                    tr[v] = M::op(tr[v * 2], tr[v * 2 + 1]);
+                    dirty[v / 128] |= 1ULL << (v / 2 % 64);
+                }
+            }
+        };
+        for (int d = 31 - __builtin_clz(n - 1); d >= 0; --d) {
+            const int lo = 1 << d, hi = std::min(2 * lo, n);
+            const size_t w0 = lo / 64, w1 = (hi + 63) / 64;
+            if (d < 7) {
+                sweep(lo, hi, w0, w1);
+                continue;
+            }
+            parallel_ranges_((w1 - w0 + 1) / 2, threads, [&](size_t b, size_t e) {
+                sweep(lo, hi, w0 + 2 * b, std::min(w1, w0 + 2 * e));
+            });
+        }
+    }
+
+    // Value at position pos
+    const T& get(int pos) const { return tr[pos + n]; }
+
     // Set value at position pos to val
     void set(int pos, const T& val) {
-        for (tr[pos += n] = val; pos > 1; pos /= 2) {
-            if (pos & 1)
-                tr[pos / 2] = f(tr[pos ^ 1], tr[pos]);
-            else
-                tr[pos / 2] = f(tr[pos], tr[pos ^ 1]);
-        }
+        tr[pos + n] = val;
+        pull(pos);
+    }
+
+    // Changes value at position pos in place by fn(T&)
+    template <class Fn>
+    void update(int pos, Fn fn) {
+        fn(tr[pos + n]);
+        pull(pos);
     }
 };
 
@@ -0,0 +1,132 @@
+#ifndef SEGMENT_TREE_WIDE
+#define SEGMENT_TREE_WIDE
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ * One node of the wide tree: B = 64 / sizeof(T) values in a single cache line
+ */
+template <class T>
+struct alignas(64) wide_block_t {
+    static constexpr int B = 64 / sizeof(T);
+    T v[B];
+};
+
+// max of block values with indices in [lo, hi), 0 <= lo < hi <= B
+template <class T>
+T wide_block_max_(const wide_block_t<T>& b, int lo, int hi) {
+    T res = std::numeric_limits<T>::lowest();
+    for (int k = lo; k < hi; ++k) res = std::max(res, b.v[k]);
+    return res;
+}
+
+#ifdef __AVX2__
+// Two 8-lane halves are masked by comparing lane indices with lo and hi, then reduced
+template <>
+inline int32_t wide_block_max_<int32_t>(const wide_block_t<int32_t>& b, int lo, int hi) {
+    const __m256i idx0 = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i idx1 = _mm256_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i vlo = _mm256_set1_epi32(lo - 1), vhi = _mm256_set1_epi32(hi);
+    const __m256i vmin = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+    __m256i m0 = _mm256_and_si256(_mm256_cmpgt_epi32(idx0, vlo), _mm256_cmpgt_epi32(vhi, idx0));
+    __m256i m1 = _mm256_and_si256(_mm256_cmpgt_epi32(idx1, vlo), _mm256_cmpgt_epi32(vhi, idx1));
+    __m256i x0 = _mm256_blendv_epi8(vmin, _mm256_load_si256((const __m256i*)b.v), m0);
+    __m256i x1 = _mm256_blendv_epi8(vmin, _mm256_load_si256((const __m256i*)(b.v + 8)), m1);
+    __m256i x = _mm256_max_epi32(x0, x1);
+    __m128i y = _mm_max_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    y = _mm_max_epi32(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2)));
+    y = _mm_max_epi32(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(y);
+}
+#endif
+
+/**
+ * Zero-indexed static-shaped B-ary segment tree, max on segment, set val at pos
+ * Intervals is expected to be [l, r)
+ * Every node is one cache line with B = 64 / sizeof(T) children, level k + 1 stores maxima
+ * of the blocks of level k, so a query touches at most two lines per level and there are
+ * log_B(n) levels instead of log_2(n)
+ * Blocks of int32_t are reduced with masked AVX2 max when compiled with -mavx2
+ * Complexity: O(B log_B n) for get and set, but O(log_B n) cache misses
+ */
+template <class T>
+class wide_segment_tree_t {
+    static_assert(std::is_arithmetic<T>::value);
+
+    using block_t = wide_block_t<T>;
+    static constexpr int B = block_t::B;
+
+    int n;
+    std::vector<std::vector<block_t>> levels;
+
+    void clamp(int& pos) { pos = std::min(std::max(0, pos), n); }
+
+    void build(const std::vector<T>& vec) {
+        const T nullval = std::numeric_limits<T>::lowest();
+        int cnt = n;
+        do {
+            levels.emplace_back((cnt + B - 1) / B);
+            for (auto& b : levels.back()) std::fill(b.v, b.v + B, nullval);
+            cnt = levels.back().size();
+        } while (cnt > 1);
+        for (int i = 0; i < n; ++i) levels[0][i / B].v[i % B] = vec[i];
+        for (size_t k = 0; k + 1 < levels.size(); ++k)
+            for (size_t i = 0; i < levels[k].size(); ++i)
+                levels[k + 1][i / B].v[i % B] = wide_block_max_(levels[k][i], 0, B);
+    }
+
+   public:
+    wide_segment_tree_t(const std::vector<T>& vec) : n(vec.size()) { build(vec); }
+
+    wide_segment_tree_t(int n, const T& x = std::numeric_limits<T>::lowest())
+        : wide_segment_tree_t(std::vector<T>(n, x)) {}
+
+    int size() const { return n; }
+
+    // Get max of elements on segment [l, r)
+    T get(int l, int r) {
+        clamp(l), clamp(r);
+        T res = std::numeric_limits<T>::lowest();
+        if (l >= r) return res;
+        // Lines of all levels are requested up front so that their misses overlap
+        for (int k = 0, pl = l, pr = r - 1; k < (int)levels.size(); ++k, pl /= B, pr /= B) {
+            __builtin_prefetch(&levels[k][pl / B]);
+            __builtin_prefetch(&levels[k][pr / B]);
+        }
+        for (int k = 0; l < r; ++k) {
+            const block_t* lv = levels[k].data();
+            if (l / B == (r - 1) / B) {
+                res = std::max(res, wide_block_max_(lv[l / B], l % B, (r - 1) % B + 1));
+                break;
+            }
+            if (l % B) res = std::max(res, wide_block_max_(lv[l / B], l % B, B)), l += B;
+            if (r % B) res = std::max(res, wide_block_max_(lv[r / B], 0, r % B));
+            l /= B, r /= B;
+        }
+        return res;
+    }
+
+    // Value at position pos
+    T get(int pos) const { return levels[0][pos / B].v[pos % B]; }
+
+    // Set value at position pos to val, stops as soon as a block maximum does not change
+    void set(int pos, const T& val) {
+        levels[0][pos / B].v[pos % B] = val;
+        for (size_t k = 0; k + 1 < levels.size(); ++k, pos /= B) {
+            T mx = wide_block_max_(levels[k][pos / B], 0, B);
+            T& parent = levels[k + 1][pos / B / B].v[pos / B % B];
+            if (parent == mx) break;
+            parent = mx;
+        }
+    }
+};
+
+#endif /* SEGMENT_TREE_WIDE */
@@ -0,0 +1,170 @@
+#ifndef SPARSE_TABLE
+#define SPARSE_TABLE
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "segment_tree_fast.hpp"
+
+/**
+ * Zero-indexed sparse table for idempotent Monoid::op (max, min, gcd, and, or)
+ * Level k holds op of [i, i + 2^k), all levels are in one array with stride n, every level is
+ * built by one elementwise pass over the previous one
+ * Intervals is expected to be [l, r), 0 <= l <= r <= n
+ * Complexity: O(n log n) to build, O(1) per query
+ */
+template <class Monoid>
+class sparse_table_t {
+   public:
+    using M = typename as_monoid_<Monoid>::type;
+    using T = typename M::value_type;
+
+   private:
+    int n, lg;
+    std::vector<T> data;
+
+   public:
+    sparse_table_t(const std::vector<T>& vec) : n(vec.size()), lg(1) {
+        while ((1 << lg) <= n) ++lg;
+        data.resize(static_cast<size_t>(lg) * n);
+        std::copy(vec.begin(), vec.end(), data.begin());
+        for (int k = 1; k < lg; ++k) {
+            const T* src = data.data() + static_cast<size_t>(k - 1) * n;
+            T* dst = data.data() + static_cast<size_t>(k) * n;
+            const int half = 1 << (k - 1);
+            for (int i = 0; i + 2 * half <= n; ++i) dst[i] = M::op(src[i], src[i + half]);
+        }
+    }
+
+    int size() const { return n; }
+
+    // Get op of elements on segment [l, r)
+    T get(int l, int r) const {
+        if (l >= r) return M::id();
+        const int k = 31 - __builtin_clz(r - l);
+        const T* row = data.data() + static_cast<size_t>(k) * n;
+        return M::op(row[l], row[r - (1 << k)]);
+    }
+};
+
+/**
+ * Zero-indexed disjoint sparse table for any associative Monoid::op
+ * Size is padded to a power of two, on level k every block of size 2^{k+1} stores op of
+ * suffixes of its left half and prefixes of its right half, so [l, r) is split at the
+ * middle of the lowest block containing it, found by the highest bit of l ^ (r - 1)
+ * Intervals is expected to be [l, r), 0 <= l <= r <= n
+ * Complexity: O(n log n) to build, O(1) per query
+ */
+template <class Monoid>
+class disjoint_sparse_table_t {
+   public:
+    using M = typename as_monoid_<Monoid>::type;
+    using T = typename M::value_type;
+
+   private:
+    int n, sz, lg;
+    std::vector<T> data;
+
+   public:
+    disjoint_sparse_table_t(const std::vector<T>& vec) : n(vec.size()), sz(1), lg(0) {
+        while (sz < n) sz *= 2, ++lg;
+        // Level 0 is the array itself, used when l + 1 = r
+        data.assign(static_cast<size_t>(lg + 1) * sz, M::id());
+        std::copy(vec.begin(), vec.end(), data.begin());
+        for (int k = 1; k <= lg; ++k) {
+            T* row = data.data() + static_cast<size_t>(k) * sz;
+            const int half = 1 << (k - 1);
+            for (int mid = half; mid < n; mid += 2 * half) {
+                row[mid - 1] = data[mid - 1];
+                for (int i = mid - 2; i >= mid - half; --i) row[i] = M::op(data[i], row[i + 1]);
+                row[mid] = data[mid];
+                for (int i = mid + 1; i < std::min(mid + half, n); ++i)
+                    row[i] = M::op(row[i - 1], data[i]);
+            }
+        }
+    }
+
+    int size() const { return n; }
+
+    // Get op of elements on segment [l, r) in order
+    T get(int l, int r) const {
+        if (l >= r) return M::id();
+        if (--r == l) return data[l];
+        const int k = 32 - __builtin_clz(l ^ r);
+        const T* row = data.data() + static_cast<size_t>(k) * sz;
+        return M::op(row[l], row[r]);
+    }
+};
+
+/**
+ * Zero-indexed static range minimum with respect to Compare in O(n) memory
+ * Blocks of 32: inside a block, mask[i] is the set of positions left on the monotonic stack
+ * after pushing i, the minimum of [l, i] is its lowest bit not below l
+ * Minima of whole blocks go to a sparse table of n / 32 elements
+ * Takes about 8n bytes for 32-bit T plus (n / 32) log(n / 32) values
+ * Intervals is expected to be [l, r), 0 <= l < r <= n
+ * Complexity: O(n) to build, O(1) per query
+ */
+template <class T, class Compare = std::less<T>>
+class rmq_t {
+    static constexpr int BLOCK = 32;
+
+    struct select_ {
+        using value_type = T;
+        static T id() { return T(); }
+        static T op(const T& x, const T& y) { return Compare()(y, x) ? y : x; }
+    };
+
+    // Value and mask side by side, so a block end costs one cache miss instead of two
+    struct item_ {
+        T val;
+        uint32_t mask;
+    };
+
+    std::vector<item_> a;
+    sparse_table_t<select_> blocks;
+
+    // Minimum of [l, r], both in the same block
+    T in_block(int l, int r) const {
+        uint32_t m = a[r].mask & (~0u << (l % BLOCK));
+        return a[r - r % BLOCK + __builtin_ctz(m)].val;
+    }
+
+    static std::vector<T> block_minima(const std::vector<T>& vec) {
+        std::vector<T> res((vec.size() + BLOCK - 1) / BLOCK);
+        for (size_t i = 0; i < vec.size(); ++i)
+            res[i / BLOCK] = i % BLOCK ? select_::op(res[i / BLOCK], vec[i]) : vec[i];
+        return res;
+    }
+
+   public:
+    rmq_t(const std::vector<T>& vec) : a(vec.size()), blocks(block_minima(vec)) {
+        const Compare cmp;
+        for (size_t s = 0; s < vec.size(); s += BLOCK) {
+            uint32_t cur = 0;
+            for (size_t i = s; i < std::min(vec.size(), s + BLOCK); ++i) {
+                while (cur && !cmp(vec[s + 31 - __builtin_clz(cur)], vec[i]))
+                    cur ^= 1u << (31 - __builtin_clz(cur));
+                a[i] = {vec[i], cur |= 1u << (i - s)};
+            }
+        }
+    }
+
+    int size() const { return a.size(); }
+
+    // Get minimum on segment [l, r)
+    T get(int l, int r) const {
+        assert(l < r);
+        --r;
+        const int bl = l / BLOCK, br = r / BLOCK;
+        if (bl == br) return in_block(l, r);
+        T res = select_::op(in_block(l, bl * BLOCK + BLOCK - 1), in_block(br * BLOCK, r));
+        if (bl + 1 < br) res = select_::op(res, blocks.get(bl + 1, br));
+        return res;
+    }
+};
+
+#endif /* SPARSE_TABLE */